@@ -0,0 +1,62 @@
+/*
+ * area_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The area_flood() used up to NLarn 0.8, which recurses into all four
+ * neighbours of every point it fills.
+ */
+
+#include "bench.h"
+
+static void area_flood_reference_worker(area *flood, area *obstacles,
+                                        int x, int y);
+
+area *area_flood_reference(area *obstacles, int start_x, int start_y)
+{
+    area *flood = area_new(obstacles->start_x, obstacles->start_y,
+                           obstacles->size_x, obstacles->size_y);
+
+    area_flood_reference_worker(flood, obstacles, start_x, start_y);
+
+    area_destroy(obstacles);
+
+    return flood;
+}
+
+static void area_flood_reference_worker(area *flood, area *obstacles,
+                                        int x, int y)
+{
+    /* stepped out of area */
+    if (!area_point_valid(flood, x, y))
+        return;
+
+    /* can't flood this */
+    if (area_point_get(obstacles, x, y))
+        return;
+
+    /* been here before */
+    if (area_point_get(flood, x, y))
+        return;
+
+    area_point_set(flood, x, y);
+
+    area_flood_reference_worker(flood, obstacles, x + 1, y);
+    area_flood_reference_worker(flood, obstacles, x - 1, y);
+    area_flood_reference_worker(flood, obstacles, x, y + 1);
+    area_flood_reference_worker(flood, obstacles, x, y - 1);
+}
@@ -0,0 +1,1494 @@
+/*
+ * bench.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Micro benchmarks for performance critical game functions.
+ *
+ * The benchmark creates complete games with fixed seeds and times the
+ * functions in question on the generated levels, which include levels
+ * from the maze file as well as randomly generated ones. The display is
+ * replaced by a stub, thus the benchmark runs without curses.
+ *
+ * "nlarn-bench <games>" only generates the levels of the given number of
+ * games, e.g. 10000 to reproduce the distribution of mazes per level.
+ */
+
+#include <glib.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "config.h"
+#include "extdefs.h"
+#include "fov.h"
+#include "game.h"
+#include "pathfinding.h"
+#include "player.h"
+#include "random.h"
+
+/* the globals usually defined in nlarn.c */
+const char *nlarn_version = "bench";
+game *nlarn = NULL;
+struct game_config config = {};
+jmp_buf nlarn_death_jump;
+
+const char *nlarn_libdir;
+const char *nlarn_mesgfile;
+const char *nlarn_helpfile;
+const char *nlarn_mazefile;
+const char *nlarn_fortunes;
+const char *nlarn_highscores;
+const char *nlarn_inifile;
+const char *nlarn_savefile;
+
+/* number of games generated */
+#define BENCH_GAMES 4
+/* number of path queries per level */
+#define BENCH_PATHS 200
+/* number of targets per level and of walkers per target */
+#define BENCH_TARGETS 20
+#define BENCH_WALKERS 50
+/* number of goals per nearest goal query */
+#define BENCH_GOALS 8
+/* number of travels across each map per game */
+#define BENCH_TRAVELS 10
+/* number of attempts to find distant connected positions */
+#define BENCH_ATTEMPTS 10000
+/* percentage of walls the player wrongly remembers as floor */
+#define BENCH_STALE_WALLS 10
+/* number of journeys between maps per game */
+#define BENCH_JOURNEYS 200
+/* number of line of sight queries per level */
+#define BENCH_RAYS 2000
+/* number of field of vision calculations per level and radius */
+#define BENCH_FOVS 200
+/* number of flood fills per level */
+#define BENCH_FLOODS 50
+/* number of turns the map timers are run per game */
+#define BENCH_TIMER_TURNS 500
+/* number of scans over the tiles of all maps per game */
+#define BENCH_TILE_SCANS 500
+/* number of random positions drawn per level */
+#define BENCH_PLACEMENTS 2000
+/* size of a cache line */
+#define BENCH_CACHE_LINE 64
+/* number of mazes carved with the recursive carver */
+#define BENCH_MAZES 200
+/* default number of games whose levels are generated one by one */
+#define BENCH_LEVEL_GAMES 500
+
+/* number of games whose levels are generated one by one, see main() */
+static guint32 bench_level_games = BENCH_LEVEL_GAMES;
+
+/* returns the time game_init() took; only the town is generated */
+static gint64 bench_game_init(guint32 seed)
+{
+    int state[4] = { seed, seed ^ 0x9e3779b9, seed * 7 + 1, ~seed };
+    cJSON *rng = cJSON_CreateIntArray(state, 4);
+
+    rand_deserialize(rng);
+    cJSON_Delete(rng);
+
+    if (nlarn != NULL)
+        nlarn = game_destroy(nlarn);
+
+    config.difficulty = 0;
+
+    gint64 t0 = g_get_monotonic_time();
+    game_init(&config);
+
+    return g_get_monotonic_time() - t0;
+}
+
+/* returns the time game_init() took, without generating the levels */
+static gint64 bench_game_new(guint32 seed)
+{
+    const gint64 time_init = bench_game_init(seed);
+
+    /* the benchmarks work on every level */
+    for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        game_map(nlarn, nmap);
+
+    return time_init;
+}
+
+static position bench_random_pos(map *m)
+{
+    position pos = pos_invalid;
+
+    do
+    {
+        X(pos) = rand_0n(MAP_MAX_X);
+        Y(pos) = rand_0n(MAP_MAX_Y);
+        Z(pos) = m->nlevel;
+    }
+    while (!map_pos_passable(m, pos));
+
+    return pos;
+}
+
+static void bench_report_count(const char *name, gint64 time,
+                               guint64 count, const char *unit, guint ops)
+{
+    g_printf("%-21s %10.0f ns/op %8.1f %s/op\n", name,
+             1000.0 * time / ops, (double)count / ops, unit);
+}
+
+static void bench_report(const char *name, gint64 time, guint64 nodes,
+                         guint ops)
+{
+    bench_report_count(name, time, nodes, "nodes", ops);
+}
+
+static void bench_report_time(const char *name, gint64 time, guint ops)
+{
+    g_printf("%-21s %10.0f ns/op\n", name, 1000.0 * time / ops);
+}
+
+static void bench_path_find()
+{
+    position steps[MAP_SIZE], buf[MAP_SIZE];
+    guint queries = 0, mismatches = 0, unreachable = 0;
+    gint64 time_ref = 0, time_new = 0, time_steps = 0;
+    guint64 nodes = 0;
+    gint64 time_ref_unreachable = 0, time_new_unreachable = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_PATHS; query++)
+            {
+                position start = bench_random_pos(m);
+                position goal  = bench_random_pos(m);
+
+                gint64 t0 = g_get_monotonic_time();
+                int len = path_find_reference(m, start, goal, LE_MONSTER,
+                                              steps, MAP_SIZE);
+                gint64 t1 = g_get_monotonic_time();
+                path *pth = path_find(m, start, goal, LE_MONSTER);
+                gint64 t2 = g_get_monotonic_time();
+
+                nodes += path_expansions();
+                time_ref += t1 - t0;
+                time_new += t2 - t1;
+                queries++;
+
+                /* both implementations must find the same path */
+                bool same = (len < 0) == (pth == NULL);
+
+                if (pth != NULL)
+                {
+                    guint idx = 0;
+                    for (GList *iter = pth->path->head; iter; iter = iter->next)
+                    {
+                        path_element *el = iter->data;
+                        if (idx >= (guint)len || !pos_identical(el->pos, steps[idx]))
+                            same = false;
+                        idx++;
+                    }
+
+                    if (idx != (guint)len)
+                        same = false;
+
+                    gint64 t3 = g_get_monotonic_time();
+                    path_destroy(pth);
+                    time_new += g_get_monotonic_time() - t3;
+                }
+                else
+                {
+                    unreachable++;
+                    time_ref_unreachable += t1 - t0;
+                    time_new_unreachable += t2 - t1;
+                }
+
+                /* the same again, without allocating the path */
+                gint64 t4 = g_get_monotonic_time();
+                int blen = path_find_steps(m, start, goal, LE_MONSTER,
+                                           buf, MAP_SIZE);
+                time_steps += g_get_monotonic_time() - t4;
+
+                if (blen != len)
+                    same = false;
+
+                for (int idx = 0; same && idx < len; idx++)
+                {
+                    if (!pos_identical(buf[idx], steps[idx]))
+                        same = false;
+                }
+
+                if (!same)
+                    mismatches++;
+            }
+        }
+    }
+
+    g_printf("path_find (reference) %10.0f ns/op\n",
+             1000.0 * time_ref / queries);
+    bench_report("path_find", time_new, nodes, queries);
+    g_printf("path_find_steps       %10.0f ns/op\n",
+             1000.0 * time_steps / queries);
+    g_printf("  %u queries, %u unreachable, %u differing paths\n",
+             queries, unreachable, mismatches);
+
+    if (unreachable)
+    {
+        g_printf("  unreachable goals:  %10.0f ns/op (reference)"
+                 " %10.0f ns/op\n",
+                 1000.0 * time_ref_unreachable / unreachable,
+                 1000.0 * time_new_unreachable / unreachable);
+    }
+}
+
+static void bench_path_field()
+{
+    guint queries = 0, mismatches = 0;
+    gint64 time_find = 0, time_field = 0, time_flee = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+        const position ppos = nlarn->p->pos;
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int target = 0; target < BENCH_TARGETS; target++)
+            {
+                /* walkers head for the player, who must not be in the way */
+                position goal = bench_random_pos(m);
+                nlarn->p->pos = goal;
+
+                for (int walker = 0; walker < BENCH_WALKERS; walker++)
+                {
+                    position start = bench_random_pos(m);
+
+                    if (pos_identical(start, goal))
+                        continue;
+
+                    gint64 t0 = g_get_monotonic_time();
+                    path *pth = path_find(m, start, goal, LE_MONSTER);
+                    gint64 t1 = g_get_monotonic_time();
+                    position npos = path_field_next_step(m, start, goal,
+                                                         LE_MONSTER);
+                    gint64 t2 = g_get_monotonic_time();
+                    position fpos = path_field_flee_step(m, start, goal,
+                                                         LE_MONSTER);
+                    gint64 t3 = g_get_monotonic_time();
+
+                    time_find  += t1 - t0;
+                    time_field += t2 - t1;
+                    time_flee  += t3 - t2;
+                    queries++;
+
+                    /* all must agree on the goal being reachable, fleeing
+                       must not lead to the goal and following the field
+                       must lead there */
+                    bool same = (pth == NULL) == pos_identical(npos, start)
+                        && (pth == NULL) == !pos_valid(fpos)
+                        && !pos_identical(fpos, goal);
+                    guint steps = 0;
+
+                    while (same && !pos_identical(npos, goal))
+                    {
+                        position next = path_field_next_step(m, npos, goal,
+                                                             LE_MONSTER);
+
+                        if (pos_identical(next, npos) || ++steps > MAP_SIZE)
+                            same = (pth == NULL);
+
+                        if (pos_identical(next, npos))
+                            break;
+
+                        npos = next;
+                    }
+
+                    if (!same)
+                        mismatches++;
+
+                    if (pth != NULL)
+                        path_destroy(pth);
+                }
+            }
+        }
+
+        nlarn->p->pos = ppos;
+    }
+
+    g_printf("path_find (next step) %10.0f ns/op\n",
+             1000.0 * time_find / queries);
+    g_printf("path_field_next_step  %10.0f ns/op\n",
+             1000.0 * time_field / queries);
+    g_printf("path_field_flee_step  %10.0f ns/op\n",
+             1000.0 * time_flee / queries);
+    g_printf("  %u queries, %u failed walks\n", queries, mismatches);
+}
+
+/* the cost of a path, i.e. the score of its last step */
+static guint32 bench_path_cost(path *pth)
+{
+    path_element *last = g_queue_peek_tail(pth->path);
+    return last ? last->g_score : 0;
+}
+
+static void bench_path_nearest()
+{
+    guint queries = 0, worse = 0;
+    gint64 time_each = 0, time_nearest = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_PATHS / 4; query++)
+            {
+                position start = bench_random_pos(m);
+                position goals[BENCH_GOALS];
+
+                for (int i = 0; i < BENCH_GOALS; i++)
+                    goals[i] = bench_random_pos(m);
+
+                /* one search per goal */
+                guint32 best = G_MAXUINT32;
+                gint64 t0 = g_get_monotonic_time();
+
+                for (int i = 0; i < BENCH_GOALS; i++)
+                {
+                    path *pth = path_find(m, start, goals[i], LE_MONSTER);
+                    if (pth == NULL) continue;
+
+                    if (bench_path_cost(pth) < best)
+                        best = bench_path_cost(pth);
+                    path_destroy(pth);
+                }
+
+                gint64 t1 = g_get_monotonic_time();
+                path *pth = path_find_nearest(m, start, goals, BENCH_GOALS,
+                                              LE_MONSTER);
+                gint64 t2 = g_get_monotonic_time();
+
+                time_each    += t1 - t0;
+                time_nearest += t2 - t1;
+                queries++;
+
+                /* the nearest goal must not be farther than any path found */
+                if ((pth == NULL) != (best == G_MAXUINT32)
+                        || (pth != NULL && bench_path_cost(pth) > best))
+                {
+                    worse++;
+                }
+
+                if (pth != NULL)
+                    path_destroy(pth);
+            }
+        }
+    }
+
+    g_printf("path_find x %d         %10.0f ns/op\n", BENCH_GOALS,
+             1000.0 * time_each / queries);
+    g_printf("path_find_nearest     %10.0f ns/op\n",
+             1000.0 * time_nearest / queries);
+    g_printf("  %u queries, %u worse than path_find\n", queries, worse);
+}
+
+/* let the player remember all maps */
+static void bench_explore_all()
+{
+    for (int nmap = 0; nmap < MAP_MAX; nmap++)
+    {
+        map *m = game_map(nlarn, nmap);
+        position pos = pos_invalid;
+        Z(pos) = nmap;
+
+        for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+        {
+            for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+            {
+                player_memory_of(nlarn->p, pos).type = map_tiletype_at(m, pos);
+                player_memory_of(nlarn->p, pos).sobject = map_sobject_at(m, pos);
+            }
+        }
+    }
+}
+
+/* the exit a player arrives at when taking an exit */
+static position bench_exit_arrival(position pos)
+{
+    switch (map_sobject_at(game_map(nlarn, Z(pos)), pos))
+    {
+    case LS_STAIRSDOWN:
+        return map_find_sobject(game_map(nlarn, Z(pos) + 1), LS_STAIRSUP);
+    case LS_STAIRSUP:
+        return map_find_sobject(game_map(nlarn, Z(pos) - 1),
+                                Z(pos) == 1 ? LS_CAVERNS_ENTRY : LS_STAIRSDOWN);
+    case LS_ELEVATORDOWN:
+        return map_find_sobject(game_map(nlarn, MAP_CMAX), LS_ELEVATORUP);
+    case LS_ELEVATORUP:
+        return map_find_sobject(game_map(nlarn, 0), LS_ELEVATORDOWN);
+    case LS_CAVERNS_ENTRY:
+        return map_find_sobject(game_map(nlarn, 1), LS_CAVERNS_EXIT);
+    case LS_CAVERNS_EXIT:
+        return map_find_sobject(game_map(nlarn, 0), LS_CAVERNS_ENTRY);
+    default:
+        return pos_invalid;
+    }
+}
+
+/* let the player learn the true map around the current position */
+static void bench_reveal(map *m, int radius)
+{
+    position pos = nlarn->p->pos;
+
+    for (int y = Y(nlarn->p->pos) - radius; y <= Y(nlarn->p->pos) + radius; y++)
+    {
+        for (int x = X(nlarn->p->pos) - radius; x <= X(nlarn->p->pos) + radius; x++)
+        {
+            if (x < 0 || y < 0 || x >= MAP_MAX_X || y >= MAP_MAX_Y)
+                continue;
+
+            X(pos) = x;
+            Y(pos) = y;
+            player_memory_of(nlarn->p, pos).type = map_tiletype_at(m, pos);
+        }
+    }
+}
+
+/* Travel across maps the player remembers wrongly. Each step, the player
+   learns the surroundings and plans the rest of the way again. */
+static void bench_path_incremental()
+{
+    guint travels = 0, steps = 0, failed = 0;
+    guint64 exp_astar = 0, exp_dstar = 0;
+    gint64 time_astar = 0, time_dstar = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+        bench_explore_all();
+        const position ppos = nlarn->p->pos;
+
+        for (int nmap = 1; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int travel = 0; travel < BENCH_TRAVELS; travel++)
+            {
+                position start, goal;
+                path *pth;
+                int attempts = 0;
+
+                /* pick distant positions connected to each other; levels
+                   divided by closed doors may not have any */
+                do
+                {
+                    start = bench_random_pos(m);
+                    goal  = bench_random_pos(m);
+                    pth   = path_find(m, start, goal, LE_GROUND);
+                    if (pth) path_destroy(pth);
+                }
+                while ((pth == NULL || pos_distance(start, goal) < 40)
+                       && ++attempts < BENCH_ATTEMPTS);
+
+                if (attempts == BENCH_ATTEMPTS)
+                    continue;
+
+                /* remember some walls as floor */
+                position pos = pos_invalid;
+                Z(pos) = nmap;
+                for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+                    for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+                        player_memory_of(nlarn->p, pos).type =
+                            (map_tiletype_at(m, pos) == LT_WALL
+                             && chance(BENCH_STALE_WALLS))
+                            ? LT_FLOOR : map_tiletype_at(m, pos);
+
+                nlarn->p->pos = start;
+                travels++;
+
+                while (!pos_identical(nlarn->p->pos, goal))
+                {
+                    bench_reveal(m, 2);
+
+                    gint64 t0 = g_get_monotonic_time();
+                    pth = path_find(m, nlarn->p->pos, goal, LE_GROUND);
+                    gint64 t1 = g_get_monotonic_time();
+                    exp_astar += path_expansions();
+                    if (pth) path_destroy(pth);
+
+                    gint64 t2 = g_get_monotonic_time();
+                    pth = path_find_incremental(m, nlarn->p->pos, goal);
+                    gint64 t3 = g_get_monotonic_time();
+                    exp_dstar += path_expansions();
+
+                    time_astar += t1 - t0;
+                    time_dstar += t3 - t2;
+                    steps++;
+
+                    if (pth == NULL || g_queue_is_empty(pth->path)
+                            || steps > (guint)BENCH_TRAVELS * MAP_MAX * MAP_SIZE)
+                    {
+                        if (pth) path_destroy(pth);
+                        failed++;
+                        break;
+                    }
+
+                    path_element *el = g_queue_peek_head(pth->path);
+                    nlarn->p->pos = el->pos;
+                    path_destroy(pth);
+                }
+            }
+        }
+
+        nlarn->p->pos = ppos;
+    }
+
+    g_printf("path_find (replan)    %10.0f ns/step %8.1f nodes/step\n",
+             1000.0 * time_astar / steps, (double)exp_astar / steps);
+    g_printf("path_find_incremental %10.0f ns/step %8.1f nodes/step\n",
+             1000.0 * time_dstar / steps, (double)exp_dstar / steps);
+    g_printf("  %u travels, %u steps, %u failed\n", travels, steps, failed);
+}
+
+static void bench_path_journey()
+{
+    guint journeys = 0, plans = 0, unreachable = 0, failed = 0;
+    gint64 time_plan = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+        bench_explore_all();
+        const position ppos = nlarn->p->pos;
+
+        for (int journey = 0; journey < BENCH_JOURNEYS; journey++)
+        {
+            position goal = bench_random_pos(game_map(nlarn, rand_0n(MAP_MAX)));
+            nlarn->p->pos = bench_random_pos(game_map(nlarn, rand_0n(MAP_MAX)));
+            journeys++;
+
+            /* follow the plan, moving the player along instantly */
+            for (int hop = 0; hop <= 2 * MAP_MAX; hop++)
+            {
+                gint64 t0 = g_get_monotonic_time();
+                path *pth = path_find_journey(goal);
+                time_plan += g_get_monotonic_time() - t0;
+                plans++;
+
+                if (pth == NULL)
+                {
+                    /* e.g. positions behind closed doors */
+                    unreachable++;
+                    break;
+                }
+
+                position dest = pth->goal;
+                path_destroy(pth);
+
+                if (pos_identical(dest, goal))
+                    break;
+
+                nlarn->p->pos = bench_exit_arrival(dest);
+
+                if (!pos_valid(nlarn->p->pos))
+                {
+                    failed++;
+                    break;
+                }
+            }
+        }
+
+        nlarn->p->pos = ppos;
+    }
+
+    g_printf("path_find_journey     %10.0f ns/op\n",
+             1000.0 * time_plan / plans);
+    g_printf("  %u journeys, %u plans, %u unreachable, %u failed\n",
+             journeys, plans, unreachable, failed);
+}
+
+static void bench_fov()
+{
+    const int radius[] = { 6, 15 };
+    gint64 time_ref[2] = { 0 }, time_fov[2] = { 0 };
+    guint64 visible[2] = { 0 };
+    guint fovs = 0, mismatches = 0;
+    guchar data[MAP_MAX_Y][MAP_MAX_X];
+
+    fov *fv = fov_new();
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_FOVS; query++)
+            {
+                const position pos = bench_random_pos(m);
+
+                for (int r = 0; r < 2; r++)
+                {
+                    gint64 t0 = g_get_monotonic_time();
+                    fov_calculate_reference(data, m, pos, radius[r]);
+                    gint64 t1 = g_get_monotonic_time();
+                    fov_calculate(fv, m, pos, radius[r], false);
+                    gint64 t2 = g_get_monotonic_time();
+
+                    time_ref[r] += t1 - t0;
+                    time_fov[r] += t2 - t1;
+
+                    /* both implementations must light the same tiles */
+                    bool same = true;
+                    position vpos = pos;
+                    for (Y(vpos) = 0; Y(vpos) < MAP_MAX_Y; Y(vpos)++)
+                    {
+                        for (X(vpos) = 0; X(vpos) < MAP_MAX_X; X(vpos)++)
+                        {
+                            visible[r] += fov_get(fv, vpos);
+
+                            if (fov_get(fv, vpos) != data[Y(vpos)][X(vpos)])
+                                same = false;
+                        }
+                    }
+
+                    if (!same)
+                        mismatches++;
+                }
+
+                fovs++;
+            }
+        }
+    }
+
+    fov_free(fv);
+
+    bench_report("fov (reference, r=6)", time_ref[0], visible[0], fovs);
+    bench_report("fov_calculate (r=6)", time_fov[0], visible[0], fovs);
+    bench_report("fov (reference, r=15)", time_ref[1], visible[1], fovs);
+    bench_report("fov_calculate (r=15)", time_fov[1], visible[1], fovs);
+    g_printf("  %u calculations, %u differing\n", 2 * fovs, mismatches);
+}
+
+static void bench_update_fov()
+{
+    gint64 time_moved = 0, time_idle = 0;
+    guint64 visible = 0;
+    guint updates = 0, mismatches = 0;
+    static player_tile_memory memory[MAP_MAX_Y][MAP_MAX_X];
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+        player *p = nlarn->p;
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+            p->pos = bench_random_pos(m);
+
+            for (int query = 0; query < BENCH_FOVS; query++)
+            {
+                /* take a step, or teleport if stuck */
+                position npos = pos_move(p->pos, rand_1n(GD_MAX));
+                p->pos = (pos_valid(npos) && map_pos_passable(m, npos))
+                    ? npos : bench_random_pos(m);
+
+                gint64 t0 = g_get_monotonic_time();
+                player_update_fov(p);
+                gint64 t1 = g_get_monotonic_time();
+                player_update_fov(p);
+                gint64 t2 = g_get_monotonic_time();
+
+                time_moved += t1 - t0;
+                time_idle += t2 - t1;
+
+                /* memorizing all visible tiles again must not change
+                   the memory */
+                memcpy(memory, p->memory[nmap], sizeof(memory));
+                p->memory_generation = 0;
+                player_update_fov(p);
+
+                if (memcmp(memory, p->memory[nmap], sizeof(memory)))
+                    mismatches++;
+
+                position vpos = p->pos;
+                for (Y(vpos) = 0; Y(vpos) < MAP_MAX_Y; Y(vpos)++)
+                    for (X(vpos) = 0; X(vpos) < MAP_MAX_X; X(vpos)++)
+                        visible += fov_get(p->fv, vpos);
+
+                updates++;
+            }
+        }
+    }
+
+    bench_report("player_update_fov", time_moved, visible, updates);
+    bench_report("  (unchanged)", time_idle, visible, updates);
+    g_printf("  %u updates, %u differing memories\n", updates, mismatches);
+}
+
+static void bench_sightlines()
+{
+    gint64 time_ray = 0, time_fov = 0;
+    guint64 targets = 0, visible_ray = 0, visible_fov = 0;
+    guint turns = 0, checked = 0, asymmetric = 0;
+
+    fov *fv = fov_new();
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+        player *p = nlarn->p;
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_FOVS; query++)
+            {
+                p->pos = bench_random_pos(m);
+
+                /* every position a monster could watch the player from */
+                position tpos = p->pos;
+                position tgts[MAP_SIZE];
+                guint count = 0;
+
+                for (Y(tpos) = 0; Y(tpos) < MAP_MAX_Y; Y(tpos)++)
+                    for (X(tpos) = 0; X(tpos) < MAP_MAX_X; X(tpos)++)
+                        if (pos_distance(tpos, p->pos) <= MONSTER_VISRANGE_MAX
+                                && map_pos_passable(m, tpos))
+                            tgts[count++] = tpos;
+
+                gint64 t0 = g_get_monotonic_time();
+                for (guint idx = 0; idx < count; idx++)
+                    visible_ray += map_pos_is_visible(m, tgts[idx], p->pos);
+                gint64 t1 = g_get_monotonic_time();
+                for (guint idx = 0; idx < count; idx++)
+                    visible_fov += player_seen_from(p, tgts[idx]);
+                gint64 t2 = g_get_monotonic_time();
+
+                time_ray += t1 - t0;
+                time_fov += t2 - t1;
+                targets += count;
+                turns++;
+
+                /* the player must be visible from where it can be seen;
+                   this holds for transparent positions only */
+                for (guint idx = 0; idx < count && idx < 4; idx++)
+                {
+                    if (!map_pos_transparent(m, p->pos)
+                            || !map_pos_transparent(m, tgts[idx]))
+                        continue;
+
+                    fov_calculate_symmetric(fv, m, tgts[idx],
+                                            MONSTER_VISRANGE_MAX);
+
+                    if (player_seen_from(p, tgts[idx]) != fov_get(fv, p->pos))
+                        asymmetric++;
+
+                    checked++;
+                }
+            }
+        }
+    }
+
+    fov_free(fv);
+
+    bench_report("map_pos_is_visible", time_ray, targets, turns);
+    bench_report("player_seen_from", time_fov, targets, turns);
+    g_printf("  %u turns, %" G_GUINT64_FORMAT " / %" G_GUINT64_FORMAT
+             " visible, %u of %u asymmetric\n",
+             turns, visible_ray, visible_fov, asymmetric, checked);
+}
+
+/* the ordering used while the visible monsters were kept in a hash */
+static gint bench_monster_sort(gconstpointer a, gconstpointer b,
+                               gpointer center)
+{
+    int da = pos_distance(*(position *)center, monster_pos((monster *)a));
+    int db = pos_distance(*(position *)center, monster_pos((monster *)b));
+
+    return (da > db) - (da < db);
+}
+
+static void bench_visible_monsters()
+{
+    gint64 time_ref = 0, time_new = 0;
+    guint64 seen = 0;
+    guint queries = 0, mismatches = 0;
+
+    fov *fv = fov_new();
+    GHashTable *mhash = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_FOVS; query++)
+            {
+                position pos = bench_random_pos(m);
+                fov_calculate(fv, m, pos, 15, true);
+
+                monster *mon;
+                g_hash_table_remove_all(mhash);
+                for (guint idx = 0; (mon = fov_visible_monster(fv, idx)); idx++)
+                    g_hash_table_insert(mhash, mon, 0);
+
+                /* the closest monster and a pass over all visible monsters,
+                   as done by travel and run mode on each step */
+                gint64 t0 = g_get_monotonic_time();
+                GList *mlist = g_hash_table_get_keys(mhash);
+                mlist = g_list_sort_with_data(mlist, bench_monster_sort, &pos);
+                monster *closest_ref = mlist ? mlist->data : NULL;
+                GList *threats = NULL;
+                for (GList *iter = mlist; iter != NULL; iter = iter->next)
+                    threats = g_list_append(threats, iter->data);
+                g_list_free(threats);
+                g_list_free(mlist);
+                gint64 t1 = g_get_monotonic_time();
+                monster *closest = fov_get_closest_monster(fv);
+                guint count = 0;
+                for (guint idx = 0; (mon = fov_visible_monster(fv, idx)); idx++)
+                    count++;
+                gint64 t2 = g_get_monotonic_time();
+
+                time_ref += t1 - t0;
+                time_new += t2 - t1;
+                seen += count;
+                queries++;
+
+                /* equally close monsters may be returned in either order */
+                if ((closest == NULL) != (closest_ref == NULL)
+                        || (closest && pos_distance(pos, monster_pos(closest))
+                            != pos_distance(pos, monster_pos(closest_ref))))
+                    mismatches++;
+            }
+        }
+    }
+
+    g_hash_table_destroy(mhash);
+    fov_free(fv);
+
+    bench_report("monster list (hash)", time_ref, seen, queries);
+    bench_report("fov_visible_monster", time_new, seen, queries);
+    g_printf("  %u queries, %u differing\n", queries, mismatches);
+}
+
+static void bench_ray()
+{
+    gint64 time_visible = 0, time_ref = 0, time_fill = 0;
+    guint64 tiles = 0;
+    guint rays = 0, visible = 0, mismatches = 0;
+    position steps[MAP_RAY_MAX];
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_RAYS; query++)
+            {
+                const position source = bench_random_pos(m);
+                const position target = bench_random_pos(m);
+
+                gint64 t0 = g_get_monotonic_time();
+                visible += map_pos_is_visible(m, source, target);
+                gint64 t1 = g_get_monotonic_time();
+                GList *ray = map_ray_reference(m, source, target);
+                gint64 t2 = g_get_monotonic_time();
+                guint len = map_ray_fill(m, source, target, steps);
+                gint64 t3 = g_get_monotonic_time();
+
+                time_visible += t1 - t0;
+                time_ref += t2 - t1;
+                time_fill += t3 - t2;
+
+                /* both must return the same positions */
+                bool same = (g_list_length(ray) == len);
+                guint idx = 0;
+                for (GList *iter = ray; same && iter; iter = iter->next)
+                    same = (GPOINTER_TO_UINT(iter->data) == steps[idx++].val);
+
+                if (!same)
+                    mismatches++;
+
+                /* the tiles on the line between the positions; all stop
+                   at the first opaque one */
+                tiles += max(abs(X(target) - X(source)),
+                             abs(Y(target) - Y(source)));
+                rays++;
+
+                g_list_free(ray);
+            }
+        }
+    }
+
+    bench_report("map_pos_is_visible", time_visible, tiles, rays);
+    bench_report("map_ray (reference)", time_ref, tiles, rays);
+    bench_report("map_ray_fill", time_fill, tiles, rays);
+    g_printf("  %u queries, %u visible, %u differing\n",
+             rays, visible, mismatches);
+}
+
+static void bench_area_flood()
+{
+    gint64 time_ref = 0, time_flood = 0, time_games = 0, time_init = 0;
+    guint64 flooded = 0;
+    guint floods = 0, mismatches = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        /* all levels are validated with a flood fill when generated */
+        gint64 t0 = g_get_monotonic_time();
+        time_init += bench_game_new(seed);
+        time_games += g_get_monotonic_time() - t0;
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            for (int query = 0; query < BENCH_FLOODS; query++)
+            {
+                const position start = bench_random_pos(m);
+
+                /* area_flood() consumes the obstacles */
+                area *obstacles = area_new(0, 0, MAP_MAX_X, MAP_MAX_Y);
+                area *obstacles_ref = area_new(0, 0, MAP_MAX_X, MAP_MAX_Y);
+                position pos = start;
+
+                for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+                    for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+                        if (!map_pos_passable(m, pos))
+                        {
+                            area_point_set(obstacles, X(pos), Y(pos));
+                            area_point_set(obstacles_ref, X(pos), Y(pos));
+                        }
+
+                gint64 t1 = g_get_monotonic_time();
+                area *ref = area_flood_reference(obstacles_ref, X(start), Y(start));
+                gint64 t2 = g_get_monotonic_time();
+                area *flood = area_flood(obstacles, X(start), Y(start));
+                gint64 t3 = g_get_monotonic_time();
+
+                time_ref += t2 - t1;
+                time_flood += t3 - t2;
+
+                bool same = true;
+                for (int y = 0; y < flood->size_y; y++)
+                    for (int x = 0; x < flood->size_x; x++)
+                    {
+                        flooded += area_point_get(flood, x, y) ? 1 : 0;
+                        if (area_point_get(flood, x, y) != area_point_get(ref, x, y))
+                            same = false;
+                    }
+
+                if (!same)
+                    mismatches++;
+
+                area_destroy(ref);
+                area_destroy(flood);
+                floods++;
+            }
+        }
+    }
+
+    bench_report("recursive flood", time_ref, flooded, floods);
+    bench_report("area_flood", time_flood, flooded, floods);
+    g_printf("  %u floods, %u differing\n", floods, mismatches);
+    g_printf("game_init             %10.0f ns/game\n",
+             1000.0 * time_init / BENCH_GAMES);
+    g_printf("level generation      %10.0f ns/level\n",
+             1000.0 * (time_games - time_init) / (BENCH_GAMES * (MAP_MAX - 1)));
+}
+
+/* run the map timers of a game for some turns, returning the time taken */
+static gint64 bench_timer_run(guint32 seed, bool reference, guint64 *active,
+                              guint32 *checksum)
+{
+    gint64 time = 0;
+
+    bench_game_new(seed);
+
+    for (int turn = 0; turn < BENCH_TIMER_TURNS; turn++)
+    {
+        /* light a fire now and then */
+        if (turn % 50 == 0)
+        {
+            map *m = game_map(nlarn, rand_0n(MAP_MAX));
+            const position pos = bench_random_pos(m);
+            area *fire = area_new_circle_flooded(pos, 2,
+                    map_get_obstacles(m, pos, 2, false));
+
+            map_set_tiletype(m, fire, LT_FIRE, 30);
+            area_destroy(fire);
+            map_spill_set(m, bench_random_pos(m), BLOOD_RED);
+        }
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+            gint64 t0 = g_get_monotonic_time();
+
+            if (reference)
+                map_timer_reference(m);
+            else
+                map_timer(m);
+
+            time += g_get_monotonic_time() - t0;
+            *active += m->active_count;
+        }
+    }
+
+    /* the state all timed tiles have been left in */
+    for (int nmap = 0; nmap < MAP_MAX; nmap++)
+    {
+        map *m = game_map(nlarn, nmap);
+
+        for (int y = 0; y < MAP_MAX_Y; y++)
+            for (int x = 0; x < MAP_MAX_X; x++)
+                *checksum = *checksum * 31 + m->type[y][x]
+                            + (m->timer[y][x] << 8)
+                            + (m->spilltime[y][x] << 16);
+    }
+
+    return time;
+}
+
+static void bench_map_timer()
+{
+    gint64 time_ref = 0, time_new = 0;
+    guint64 active = 0, ignored = 0;
+    guint turns = 0, mismatches = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        guint32 sum_ref = 0, sum_new = 0;
+
+        /* the reference does not clear the active tiles */
+        time_ref += bench_timer_run(seed, true, &ignored, &sum_ref);
+        time_new += bench_timer_run(seed, false, &active, &sum_new);
+
+        if (sum_ref != sum_new)
+            mismatches++;
+
+        turns += BENCH_TIMER_TURNS;
+    }
+
+    bench_report("map_timer (reference)", time_ref, active, turns);
+    bench_report("map_timer", time_new, active, turns);
+    g_printf("  %u turns, %u of %d games differing\n",
+             turns, mismatches, BENCH_GAMES);
+}
+
+static void bench_tile_scan()
+{
+    gint64 time_ref = 0, time_new = 0;
+    guint64 passable_ref = 0, passable_new = 0;
+    guint scans = 0;
+    map_tile_reference (*grids)[MAP_MAX_Y][MAP_MAX_X] =
+        g_malloc(MAP_MAX * sizeof(map_tile_reference[MAP_MAX_Y][MAP_MAX_X]));
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+            map_tiles_reference(grids[nmap], game_map(nlarn, nmap));
+
+        /* like the display or the transparency updates, read the type
+           and the stationary object of every tile of every map */
+        for (int scan = 0; scan < BENCH_TILE_SCANS; scan++)
+        {
+            gint64 t0 = g_get_monotonic_time();
+
+            for (int nmap = 0; nmap < MAP_MAX; nmap++)
+                for (int y = 0; y < MAP_MAX_Y; y++)
+                    for (int x = 0; x < MAP_MAX_X; x++)
+                        passable_ref += mt_is_passable(grids[nmap][y][x].type)
+                            && so_is_passable(grids[nmap][y][x].sobject);
+
+            gint64 t1 = g_get_monotonic_time();
+
+            for (int nmap = 0; nmap < MAP_MAX; nmap++)
+            {
+                map *m = game_map(nlarn, nmap);
+
+                for (int y = 0; y < MAP_MAX_Y; y++)
+                    for (int x = 0; x < MAP_MAX_X; x++)
+                        passable_new += mt_is_passable(m->type[y][x])
+                            && so_is_passable(m->sobject[y][x]);
+            }
+
+            gint64 t2 = g_get_monotonic_time();
+
+            time_ref += t1 - t0;
+            time_new += t2 - t1;
+            scans++;
+        }
+    }
+
+    g_free(grids);
+
+    /* The cache lines a scan has to load, derived from the size of the
+       data read. Hardware cache miss counters are not available on every
+       machine, thus they are not read. */
+    const guint64 lines_ref = MAP_MAX * sizeof(map_tile_reference[MAP_MAX_Y][MAP_MAX_X])
+                              / BENCH_CACHE_LINE;
+    const guint64 lines_new = MAP_MAX * 2 * sizeof(guint8[MAP_MAX_Y][MAP_MAX_X])
+                              / BENCH_CACHE_LINE;
+
+    bench_report_count("tile scan (reference)", time_ref, lines_ref * scans,
+                       "lines", scans);
+    bench_report_count("tile scan (planes)", time_new, lines_new * scans,
+                       "lines", scans);
+    g_printf("  %u scans, %s passable tiles\n", scans,
+             passable_ref == passable_new ? "same" : "differing");
+}
+
+/* the coefficient of variation of the hits of the positions drawn */
+static double bench_space_spread(guint hits[MAP_MAX_Y][MAP_MAX_X])
+{
+    double sum = 0, sqsum = 0;
+    guint cells = 0;
+
+    for (int y = 0; y < MAP_MAX_Y; y++)
+        for (int x = 0; x < MAP_MAX_X; x++)
+            if (hits[y][x])
+            {
+                sum += hits[y][x];
+                sqsum += (double)hits[y][x] * hits[y][x];
+                cells++;
+            }
+
+    if (cells == 0)
+        return 0;
+
+    const double mean = sum / cells;
+    return sqrt(sqsum / cells - mean * mean) / mean;
+}
+
+/* fill a map with monsters until no space is left, returning the time
+   the position searches took */
+static gint64 bench_space_crowd(map *m, bool reference, guint *monsters)
+{
+    const rectangle entire_map = rect_new(1, 1, MAP_MAX_X - 2, MAP_MAX_Y - 2);
+    gint64 time = 0;
+
+    while (true)
+    {
+        gint64 t0 = g_get_monotonic_time();
+        position pos = reference
+            ? map_find_space_reference(m, entire_map, LE_MONSTER, false)
+            : map_find_space_in(m, entire_map, LE_MONSTER, false);
+        time += g_get_monotonic_time() - t0;
+
+        if (!pos_valid(pos) || !monster_new(MT_GIANT_BAT, pos, NULL))
+            break;
+
+        (*monsters)++;
+    }
+
+    return time;
+}
+
+static void bench_find_space()
+{
+    const rectangle entire_map = rect_new(1, 1, MAP_MAX_X - 2, MAP_MAX_Y - 2);
+    gint64 time_ref = 0, time_new = 0, crowd_ref = 0, crowd_new = 0;
+    double spread_ref = 0, spread_new = 0;
+    guint draws = 0, levels = 0, monsters_ref = 0, monsters_new = 0;
+    guint (*hits)[MAP_MAX_Y][MAP_MAX_X] =
+        g_malloc(2 * sizeof(guint[MAP_MAX_Y][MAP_MAX_X]));
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int nmap = 0; nmap < MAP_MAX; nmap++)
+        {
+            map *m = game_map(nlarn, nmap);
+
+            memset(hits, 0, 2 * sizeof(guint[MAP_MAX_Y][MAP_MAX_X]));
+
+            for (int draw = 0; draw < BENCH_PLACEMENTS; draw++)
+            {
+                gint64 t0 = g_get_monotonic_time();
+                position ref = map_find_space_reference(m, entire_map,
+                                                        LE_ITEM, false);
+                gint64 t1 = g_get_monotonic_time();
+                position pos = map_find_space_in(m, entire_map, LE_ITEM, false);
+                gint64 t2 = g_get_monotonic_time();
+
+                time_ref += t1 - t0;
+                time_new += t2 - t1;
+
+                hits[0][Y(ref)][X(ref)]++;
+                hits[1][Y(pos)][X(pos)]++;
+                draws++;
+            }
+
+            spread_ref += bench_space_spread(hits[0]);
+            spread_new += bench_space_spread(hits[1]);
+            levels++;
+        }
+
+        /* crowd the first cavern level with the reference, then the
+           same level of an identical game with map_find_space_in() */
+        crowd_ref += bench_space_crowd(game_map(nlarn, 1), true, &monsters_ref);
+        bench_game_new(seed);
+        crowd_new += bench_space_crowd(game_map(nlarn, 1), false, &monsters_new);
+    }
+
+    g_free(hits);
+
+    bench_report_time("free cell (reference)", time_ref, draws);
+    bench_report_time("map_find_space_in", time_new, draws);
+    g_printf("  %u draws, hit spread %.2f (reference) %.2f\n", draws,
+             spread_ref / levels, spread_new / levels);
+    bench_report_time("crowding (reference)", crowd_ref, monsters_ref + BENCH_GAMES);
+    bench_report_time("crowding", crowd_new, monsters_new + BENCH_GAMES);
+    g_printf("  %u / %u monsters placed\n", monsters_ref, monsters_new);
+}
+
+static void bench_maze()
+{
+    const map_generation_stats before = *map_generation_stats_get();
+    map *scratch = g_malloc0(sizeof(map));
+    gint64 time_ref = 0;
+    guint64 carved = 0;
+    int depth = 0;
+
+    for (guint32 seed = 1; seed <= BENCH_GAMES; seed++)
+    {
+        bench_game_new(seed);
+
+        for (int maze = 0; maze < BENCH_MAZES; maze++)
+        {
+            memset(scratch->type, LT_WALL, sizeof(scratch->type));
+
+            gint64 t0 = g_get_monotonic_time();
+            const int d = map_make_maze_eat_reference(scratch, 1, 1);
+            time_ref += g_get_monotonic_time() - t0;
+
+            depth = max(depth, d);
+
+            for (int y = 0; y < MAP_MAX_Y; y++)
+                for (int x = 0; x < MAP_MAX_X; x++)
+                    carved += (scratch->type[y][x] == LT_FLOOR) ? 1 : 0;
+        }
+    }
+
+    g_free(scratch);
+
+    const map_generation_stats *after = map_generation_stats_get();
+    const guint32 levels = after->levels - before.levels;
+    const guint32 mazes = after->mazes - before.mazes;
+
+    bench_report("recursive carver", time_ref, carved, BENCH_GAMES * BENCH_MAZES);
+    g_printf("  recursion depth %d, stack capacity %d cells\n",
+             depth, (MAP_MAX_X / 2 + 1) * (MAP_MAX_Y / 2 + 1));
+    g_printf("map_new               %10.0f ns/level (max %" G_GINT64_FORMAT " us)\n",
+             1000.0 * (after->time - before.time) / max(levels, 1),
+             after->time_max);
+    g_printf("map_make_maze_eat     %10.0f ns/maze\n",
+             1000.0 * (after->carve_time - before.carve_time) / max(mazes, 1));
+    g_printf("map_validate          %10.0f ns/call\n",
+             1000.0 * (after->validate_time - before.validate_time)
+             / max(after->validations - before.validations, 1));
+    g_printf("  %u levels, %u mazes, %u level / %u maze restarts, %u unreachable\n",
+             levels, mazes, after->restarts - before.restarts,
+             after->maze_restarts - before.maze_restarts,
+             after->rejections - before.rejections);
+}
+
+static gint bench_time_cmp(gconstpointer a, gconstpointer b)
+{
+    const gint64 ta = *(const gint64 *)a, tb = *(const gint64 *)b;
+
+    return (ta > tb) - (ta < tb);
+}
+
+/* generate the levels of bench_level_games games, either connecting or
+   discarding mazes with unreachable parts */
+static void bench_level_generation(const char *name, bool repair)
+{
+    /* levels needing 1, 2, 3-4, 5-8, 9-16 and more mazes */
+    guint buckets[6] = { 0 };
+    guint random_levels = 0, most = 0, carved = 0;
+    GArray *times = g_array_new(false, false, sizeof(gint64));
+    const guint32 tunnels = map_generation_stats_get()->tunnels;
+
+    map_generation_set_repair(repair);
+
+    for (guint32 seed = 1; seed <= bench_level_games; seed++)
+    {
+        bench_game_init(seed);
+
+        for (int nmap = 1; nmap < MAP_MAX; nmap++)
+        {
+            const guint32 mazes = map_generation_stats_get()->mazes;
+
+            gint64 t0 = g_get_monotonic_time();
+            game_map(nlarn, nmap);
+            gint64 t1 = g_get_monotonic_time() - t0;
+
+            g_array_append_val(times, t1);
+
+            /* levels loaded from the maze file are not carved */
+            const guint attempts = map_generation_stats_get()->mazes - mazes;
+            if (attempts == 0)
+                continue;
+
+            int bucket = 0;
+            while (bucket < 5 && attempts > (1u << bucket))
+                bucket++;
+
+            buckets[bucket]++;
+            random_levels++;
+            carved += attempts;
+            most = max(most, attempts);
+        }
+    }
+
+    map_generation_set_repair(true);
+
+    g_array_sort(times, bench_time_cmp);
+
+    const gint64 *t = (const gint64 *)times->data;
+    g_printf("%-21s %10" G_GINT64_FORMAT " us median, "
+             "%" G_GINT64_FORMAT " us p99, %" G_GINT64_FORMAT " us p99.9, "
+             "%" G_GINT64_FORMAT " us max\n",
+             name, t[times->len / 2], t[times->len * 99 / 100],
+             t[times->len * 999 / 1000], t[times->len - 1]);
+    g_printf("  %u games, %u carved levels, mazes per level: 1: %u, 2: %u, "
+             "3-4: %u, 5-8: %u, 9-16: %u, more: %u (max %u, mean %.3f)\n",
+             bench_level_games, random_levels, buckets[0], buckets[1],
+             buckets[2], buckets[3], buckets[4], buckets[5], most,
+             (double)carved / max(random_levels, 1));
+    if (repair)
+        g_printf("  %u tunnels carved\n",
+                 map_generation_stats_get()->tunnels - tunnels);
+
+    g_array_free(times, true);
+}
+
+static void bench_level_attempts()
+{
+    bench_level_generation("levels (regenerate)", false);
+    bench_level_generation("levels (connect)", true);
+}
+
+static void bench_maze_file()
+{
+    char maze[MAP_MAX_Y][MAP_MAX_X];
+    gint64 time_ref = 0;
+    guint reads = 0, failed = 0;
+
+    for (int game = 0; game < BENCH_MAZES; game++)
+    {
+        for (int map_num = 0; map_num < MAP_MAZE_NUM; map_num++)
+        {
+            gint64 t0 = g_get_monotonic_time();
+            if (!map_maze_read_reference(nlarn_mazefile, map_num, maze))
+                failed++;
+            time_ref += g_get_monotonic_time() - t0;
+            reads++;
+        }
+    }
+
+    gint64 t0 = g_get_monotonic_time();
+    char *error = map_mazes_load(nlarn_mazefile);
+    gint64 time_load = g_get_monotonic_time() - t0;
+
+    bench_report_time("maze file (reference)", time_ref, reads);
+    g_printf("map_mazes_load        %10.0f ns (all %d mazes)\n",
+             1000.0 * time_load, MAP_MAZE_NUM);
+    g_printf("  %u reads, %u failed, %s\n", reads, failed,
+             error ? error : "maze file valid");
+
+    g_free(error);
+}
+
+/* usage: nlarn-bench [games] */
+int main(int argc, char *argv[])
+{
+    g_autofree char *basedir = g_path_get_dirname(argv[0]);
+
+    nlarn_libdir = g_build_path(G_DIR_SEPARATOR_S, basedir, "lib", NULL);
+    nlarn_mazefile = g_build_filename(nlarn_libdir, "maze", NULL);
+
+    /* an empty file name can not be opened, thus no saved game is loaded */
+    nlarn_savefile = "";
+
+    if (argc > 1)
+    {
+        const int games = atoi(argv[1]);
+
+        if (games <= 0)
+        {
+            g_printerr("usage: %s [games]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        bench_level_games = games;
+        bench_level_attempts();
+        nlarn = game_destroy(nlarn);
+
+        return EXIT_SUCCESS;
+    }
+
+    bench_path_find();
+    bench_path_field();
+    bench_path_nearest();
+    bench_path_incremental();
+    bench_path_journey();
+    bench_fov();
+    bench_update_fov();
+    bench_sightlines();
+    bench_visible_monsters();
+    bench_ray();
+    bench_area_flood();
+    bench_map_timer();
+    bench_tile_scan();
+    bench_find_space();
+    bench_maze();
+    bench_maze_file();
+    bench_level_attempts();
+
+    nlarn = game_destroy(nlarn);
+
+    return EXIT_SUCCESS;
+}
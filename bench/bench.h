@@ -0,0 +1,134 @@
+/*
+ * bench.h
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <glib.h>
+
+#include "map.h"
+
+/**
+ * @brief The path finding implementation used up to NLarn 0.8.
+ *
+ * @param m the map to work on
+ * @param start the starting position
+ * @param goal the destination
+ * @param element the map_element_t that can be travelled
+ * @param steps buffer receiving the steps of the path
+ * @param max_steps the capacity of steps
+ * @return the length of the path or -1 if none could be found
+ */
+int path_find_reference(map *m, position start, position goal,
+                        map_element_t element, position *steps, int max_steps);
+
+/**
+ * @brief The field of vision calculation used up to NLarn 0.8.
+ *
+ * @param data receives the visibility of every tile of the map
+ * @param m the map to work on
+ * @param pos the center of the field of vision
+ * @param radius the radius of vision
+ */
+void fov_calculate_reference(guchar data[MAP_MAX_Y][MAP_MAX_X], map *m,
+                             position pos, int radius);
+
+/**
+ * The Bresenham implementation of map_ray() the ray tables replace.
+ *
+ * @param m The map that contains both positions.
+ * @param source The starting position.
+ * @param target The destination.
+ * @return a list of positions, NULL if the target can not be reached
+ */
+GList *map_ray_reference(map *m, position source, position target);
+
+/**
+ * The map_timer() scanning the entire map.
+ *
+ * @param m the map on which timed events have to be processed
+ */
+void map_timer_reference(map *m);
+
+/* the map tile structure used up to NLarn 0.8 */
+typedef struct map_tile_reference
+{
+    guint64
+        type:       8,
+        base_type:  8,
+        timer:      8,
+        sobject:    8,
+        trap:       8,
+        spilltime:  8;
+    gpointer m_oid;
+    inventory *ilist;
+    colour_t spill;
+} map_tile_reference;
+
+/**
+ * Copy the tiles of a map into the structure used up to NLarn 0.8.
+ *
+ * @param grid receives the tiles of the map
+ * @param m the map to copy
+ */
+void map_tiles_reference(map_tile_reference grid[MAP_MAX_Y][MAP_MAX_X], map *m);
+
+/**
+ * The map_find_space_in() walking the rectangle from a random position.
+ *
+ * @param m the map to search
+ * @param where the rectangle to search
+ * @param element the map_element_t the position has to be suitable for
+ * @param dead_end true if the position has to be in a dead end
+ * @return a suitable position or pos_invalid
+ */
+position map_find_space_reference(map *m, rectangle where,
+                                  map_element_t element, bool dead_end);
+
+/**
+ * The recursive flood fill replaced by the scanline fill.
+ *
+ * @param obstacles the points which shall not be flooded (will be freed)
+ * @param start_x the x coordinate to start flooding
+ * @param start_y the y coordinate to start flooding
+ * @return an area with all reached points set
+ */
+area *area_flood_reference(area *obstacles, int start_x, int start_y);
+
+/**
+ * The recursive maze carver replaced by the explicit stack.
+ *
+ * @param m the map filled with walls to carve the maze into
+ * @param x the x coordinate to start carving
+ * @param y the y coordinate to start carving
+ * @return the deepest recursion reached
+ */
+int map_make_maze_eat_reference(map *m, int x, int y);
+
+/**
+ * The maze file reader which read the entire file for every predefined level.
+ *
+ * @param mazefile the file containing the predefined levels
+ * @param map_num the number of the level to read
+ * @param maze receives the characters of the level
+ * @return true if the level could be read
+ */
+bool map_maze_read_reference(const char *mazefile, int map_num,
+                             char maze[MAP_MAX_Y][MAP_MAX_X]);
+
+#endif
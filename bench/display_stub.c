@@ -0,0 +1,235 @@
+/*
+ * display_stub.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replacements for the display functions used by the game code, allowing
+ * the benchmark to be linked without curses. The display is never
+ * available: nothing is drawn and all questions are declined.
+ */
+
+#include "display.h"
+#include "extdefs.h"
+
+bool display_available()
+{
+    return false;
+}
+
+void display_shutdown()
+{
+}
+
+void display_draw()
+{
+}
+
+void display_paint_screen(player *p __attribute__((unused)))
+{
+}
+
+void display_paint_glyph(position pos __attribute__((unused)),
+                         wchar_t glyph __attribute__((unused)),
+                         colour_t fg __attribute__((unused)))
+{
+}
+
+void display_animate_glyph(position pos __attribute__((unused)),
+                           wchar_t glyph __attribute__((unused)),
+                           colour_t fg __attribute__((unused)),
+                           bool keep __attribute__((unused)))
+{
+}
+
+void display_nap(guint ms __attribute__((unused)))
+{
+}
+
+item *display_inventory(const char *title __attribute__((unused)),
+                        player *p __attribute__((unused)),
+                        inventory **inv __attribute__((unused)),
+                        GPtrArray *callbacks __attribute__((unused)),
+                        bool show_price __attribute__((unused)),
+                        bool show_weight __attribute__((unused)),
+                        bool show_account __attribute__((unused)),
+                        int (*filter)(item *) __attribute__((unused)))
+{
+    return NULL;
+}
+
+void display_inv_callbacks_clean(GPtrArray *callbacks)
+{
+    if (!callbacks) return;
+
+    while (callbacks->len > 0)
+    {
+        g_free(g_ptr_array_remove_index_fast(callbacks, callbacks->len - 1));
+    }
+
+    g_ptr_array_free(callbacks, true);
+}
+
+void display_config_autopickup(bool settings[IT_MAX] __attribute__((unused)))
+{
+}
+
+spell *display_spell_select(const char *title __attribute__((unused)),
+                            player *p __attribute__((unused)),
+                            spell_t type __attribute__((unused)))
+{
+    return NULL;
+}
+
+int display_get_count(const char *caption __attribute__((unused)),
+                      int value __attribute__((unused)))
+{
+    return 0;
+}
+
+char *display_get_string(const char *title __attribute__((unused)),
+                         const char *caption __attribute__((unused)),
+                         const char *value __attribute__((unused)),
+                         size_t max_len __attribute__((unused)))
+{
+    return NULL;
+}
+
+int display_get_yesno(const char *question __attribute__((unused)),
+                      const char *title __attribute__((unused)),
+                      const char *yes __attribute__((unused)),
+                      const char *no __attribute__((unused)))
+{
+    return false;
+}
+
+direction display_get_direction(const char *title __attribute__((unused)),
+                                const char *message __attribute__((unused)),
+                                int *available __attribute__((unused)))
+{
+    return GD_NONE;
+}
+
+position display_get_new_position(player *p __attribute__((unused)),
+                                  position start __attribute__((unused)),
+                                  const char *message __attribute__((unused)),
+                                  bool ray __attribute__((unused)),
+                                  bool ball __attribute__((unused)),
+                                  bool travel __attribute__((unused)),
+                                  guint radius __attribute__((unused)),
+                                  bool passable __attribute__((unused)),
+                                  bool visible __attribute__((unused)))
+{
+    return pos_invalid;
+}
+
+position display_get_position(player *p __attribute__((unused)),
+                              const char *message __attribute__((unused)),
+                              bool ray __attribute__((unused)),
+                              bool ball __attribute__((unused)),
+                              guint radius __attribute__((unused)),
+                              bool passable __attribute__((unused)),
+                              bool visible __attribute__((unused)))
+{
+    return pos_invalid;
+}
+
+int display_show_message(const char *title __attribute__((unused)),
+                         const char *message __attribute__((unused)),
+                         int indent __attribute__((unused)))
+{
+    return 0;
+}
+
+display_window *display_popup(int x1 __attribute__((unused)),
+                              int y1 __attribute__((unused)),
+                              int width __attribute__((unused)),
+                              const char *title __attribute__((unused)),
+                              const char *msg __attribute__((unused)),
+                              int indent __attribute__((unused)))
+{
+    return NULL;
+}
+
+int display_menu(const char *title __attribute__((unused)),
+                 const char *message __attribute__((unused)),
+                 const char **options __attribute__((unused)),
+                 const bool *disabled __attribute__((unused)),
+                 const char **details __attribute__((unused)),
+                 guint n_options __attribute__((unused)),
+                 guint initial __attribute__((unused)))
+{
+    return -1;
+}
+
+int display_menu_at(int anchor_x __attribute__((unused)),
+                    int anchor_y __attribute__((unused)),
+                    const char *title __attribute__((unused)),
+                    const char *message __attribute__((unused)),
+                    const char **options __attribute__((unused)),
+                    const bool *disabled __attribute__((unused)),
+                    const char **details __attribute__((unused)),
+                    guint n_options __attribute__((unused)),
+                    guint initial __attribute__((unused)))
+{
+    return -1;
+}
+
+void display_set_pending_target(position pos __attribute__((unused)))
+{
+}
+
+void display_window_destroy(display_window *dwin __attribute__((unused)))
+{
+}
+
+void display_windows_destroy_all()
+{
+}
+
+void display_windows_hide()
+{
+}
+
+void display_windows_show()
+{
+}
+
+/* the curses functions called outside of the display code */
+int flushinp()
+{
+    return OK;
+}
+
+int napms(int ms __attribute__((unused)))
+{
+    return OK;
+}
+
+int init_color(short color __attribute__((unused)),
+               short r __attribute__((unused)),
+               short g __attribute__((unused)),
+               short b __attribute__((unused)))
+{
+    return OK;
+}
+
+int init_pair(short pair __attribute__((unused)),
+              short f __attribute__((unused)),
+              short b __attribute__((unused)))
+{
+    return OK;
+}
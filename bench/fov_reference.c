@@ -0,0 +1,138 @@
+/*
+ * fov_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The floating point shadowcasting fov_calculate() as it was before the
+ * switch to integer slopes, without the collection of visible monsters.
+ * It is kept as the reference the benchmark compares the current
+ * implementation against.
+ */
+
+#include <string.h>
+
+#include "bench.h"
+
+static void fov_reference_octant(guchar data[MAP_MAX_Y][MAP_MAX_X],
+                                 map *m, position center, int row,
+                                 float start, float end, int radius,
+                                 int xx, int xy, int yx, int yy)
+{
+    float new_start = 0;
+
+    if (start < end)
+        return;
+
+    int radius_squared = radius * radius;
+
+    for (int j = row; j <= radius + 1; j++)
+    {
+        int dx = -j - 1;
+        int dy = -j;
+
+        int blocked = false;
+
+        while (dx <= 0)
+        {
+            dx += 1;
+
+            int X = X(center) + dx * xx + dy * xy;
+            int Y = Y(center) + dx * yx + dy * yy;
+
+            if ((X < 0) || (X >= MAP_MAX_X))
+                continue;
+
+            if ((Y < 0) || (Y >= MAP_MAX_Y))
+                continue;
+
+            float l_slope = ((float)dx - 0.5f) / ((float)dy + 0.5f);
+            float r_slope = ((float)dx + 0.5f) / ((float)dy - 0.5f);
+
+            if (start < r_slope)
+            {
+                continue;
+            }
+            else if (end > l_slope)
+            {
+                break;
+            }
+            else
+            {
+                position pos = { { X, Y, m->nlevel } };
+
+                if ((dx * dx + dy * dy) < radius_squared)
+                {
+                    data[Y][X] = true;
+                }
+
+                if (blocked)
+                {
+                    if (!map_pos_transparent(m, pos))
+                    {
+                        new_start = r_slope;
+                        continue;
+                    }
+                    else
+                    {
+                        blocked = false;
+                        start = new_start;
+                    }
+                }
+                else
+                {
+                    if (!map_pos_transparent(m, pos) && (j < radius))
+                    {
+                        blocked = true;
+                    }
+
+                    fov_reference_octant(data, m, center, j + 1, start,
+                                         l_slope, radius, xx, xy, yx, yy);
+
+                    new_start = r_slope;
+                }
+            }
+        }
+
+        if (blocked)
+        {
+            break;
+        }
+    }
+}
+
+void fov_calculate_reference(guchar data[MAP_MAX_Y][MAP_MAX_X], map *m,
+                             position pos, int radius)
+{
+    const int mult[4][8] =
+    {
+        { 1,  0,  0, -1, -1,  0,  0,  1 },
+        { 0,  1, -1,  0,  0, -1,  1,  0 },
+        { 0,  1,  1,  0,  0, -1, -1,  0 },
+        { 1,  0,  0,  1, -1,  0,  0, -1 }
+    };
+
+    memset(data, 0, MAP_MAX_Y * MAP_MAX_X * sizeof(guchar));
+
+    for (int octant = 0; octant < 8; octant++)
+    {
+        fov_reference_octant(data, m, pos, 1, 1.0f, 0.0f, radius,
+                             mult[0][octant], mult[1][octant],
+                             mult[2][octant], mult[3][octant]);
+    }
+
+    data[Y(pos)][X(pos)] = true;
+}
@@ -0,0 +1,100 @@
+/*
+ * map_timer_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The map_timer() used up to NLarn 0.8, which visits every tile of the
+ * map each turn to find those with a timer or a spill.
+ */
+
+#include "bench.h"
+#include "extdefs.h"
+#include "fov.h"
+#include "game.h"
+#include "items.h"
+
+void map_timer_reference(map *m)
+{
+    position pos = pos_invalid;
+    item_erosion_type erosion;
+
+    g_assert (m != NULL);
+
+    Z(pos) = m->nlevel;
+
+    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+    {
+        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        {
+            if (map_timer_at(m, pos))
+            {
+                m->timer[Y(pos)][X(pos)]--;
+
+                /* affect items every three turns */
+                if ((m->ilist[Y(pos)][X(pos)] != NULL) && (m->timer[Y(pos)][X(pos)] % 5 == 0))
+                {
+                    switch (m->type[Y(pos)][X(pos)])
+                    {
+                    case LT_CLOUD:
+                        erosion = IET_CORRODE;
+                        break;
+
+                    case LT_FIRE:
+                        erosion = IET_BURN;
+                        break;
+
+                    case LT_WATER:
+                        erosion = IET_RUST;
+                        break;
+                    default:
+                        erosion = IET_NONE;
+                        break;
+                    }
+
+                    inv_erode(&m->ilist[Y(pos)][X(pos)], erosion,
+                            fov_get(nlarn->p->fv, pos), NULL);
+                }
+
+                /* reset tile type if temporary effect has expired */
+                if (m->timer[Y(pos)][X(pos)] == 0)
+                {
+                    if ((m->type[Y(pos)][X(pos)] == LT_FIRE)
+                            && (m->base_type[Y(pos)][X(pos)] == LT_GRASS))
+                    {
+                        m->base_type[Y(pos)][X(pos)] = LT_NONE;
+                        m->type[Y(pos)][X(pos)] = LT_DIRT;
+                    }
+                    else
+                    {
+                        m->type[Y(pos)][X(pos)] = m->base_type[Y(pos)][X(pos)];
+                    }
+
+                    map_tile_changed(m, pos);
+                }
+            } /* if map_timer_at */
+
+            if (map_spill_at(m, pos))
+            {
+                m->spilltime[Y(pos)][X(pos)]--;
+                if (m->spilltime[Y(pos)][X(pos)] < 1)
+                {
+                    m->spill[Y(pos)][X(pos)] = 0;
+                }
+            } /* map_spill_at */
+        } /* for X(pos) */
+    } /* for Y(pos) */
+}
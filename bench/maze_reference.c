@@ -0,0 +1,145 @@
+/*
+ * maze_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The map_make_maze_eat() used up to NLarn 0.8, which recurses into every
+ * cell of the maze it carves, and the maze file reader, which read the
+ * entire file for every predefined level.
+ */
+
+#include <string.h>
+
+#include "bench.h"
+#include "random.h"
+
+int map_make_maze_eat_reference(map *m, int x, int y)
+{
+    int try = 2;
+    int depth = 1;
+
+    int dir = rand_1n(4);
+
+    while (try)
+    {
+        int nx = x, ny = y;
+
+        switch (dir)
+        {
+        case 1: /* west */
+            if ((x > 2) &&
+                    (m->type[y][x - 1] == LT_WALL) &&
+                    (m->type[y][x - 2] == LT_WALL))
+            {
+                m->type[y][x - 1] = m->type[y][x - 2] = LT_FLOOR;
+                nx = x - 2;
+            }
+            break;
+
+        case 2: /* east */
+            if (x < (MAP_MAX_X - 3) &&
+                    (m->type[y][x + 1] == LT_WALL) &&
+                    (m->type[y][x + 2] == LT_WALL))
+            {
+                m->type[y][x + 1] = m->type[y][x + 2] = LT_FLOOR;
+                nx = x + 2;
+            }
+            break;
+
+        case 3: /* south */
+            if ((y > 2) &&
+                    (m->type[y - 1][x] == LT_WALL) &&
+                    (m->type[y - 2][x] == LT_WALL))
+            {
+                m->type[y - 1][x] = m->type[y - 2][x] = LT_FLOOR;
+                ny = y - 2;
+            }
+            break;
+
+        case 4: /* north */
+            if ((y < MAP_MAX_Y - 3) &&
+                    (m->type[y + 1][x] == LT_WALL) &&
+                    (m->type[y + 2][x] == LT_WALL))
+            {
+                m->type[y + 1][x] = m->type[y + 2][x] = LT_FLOOR;
+                ny = y + 2;
+            }
+
+            break;
+        };
+
+        if (nx != x || ny != y)
+        {
+            const int sub = map_make_maze_eat_reference(m, nx, ny) + 1;
+            if (sub > depth)
+                depth = sub;
+        }
+
+        if (++dir > 4)
+        {
+            dir = 1;
+            try--;
+        }
+    }
+
+    return depth;
+}
+
+bool map_maze_read_reference(const char *mazefile, int map_num,
+                             char maze[MAP_MAX_Y][MAP_MAX_X])
+{
+    gchar *content = NULL;
+
+    /* slurp maze file */
+    if (!g_file_get_contents(mazefile, &content, NULL, NULL))
+    {
+        return false;
+    }
+
+    /* Split content by line */
+    gchar **lines = g_strsplit(content, "\n", -1);
+    g_free(content);
+
+    guint num_lines = g_strv_length(lines);
+    /* every map consists of MAP_MAX_Y lines + 1 blank line */
+    guint start_line = map_num * (MAP_MAX_Y + 1);
+
+    /* validate file */
+    if (start_line + MAP_MAX_Y > num_lines)
+    {
+        g_strfreev(lines);
+        return false;
+    }
+
+    for (int y = 0; y < MAP_MAX_Y; y++)
+    {
+        gchar *line = lines[start_line + y];
+
+        /* validate line width */
+        if (strlen(line) < MAP_MAX_X)
+        {
+            g_strfreev(lines);
+            return false;
+        }
+
+        memcpy(maze[y], line, MAP_MAX_X);
+    }
+
+    g_strfreev(lines);
+
+    return true;
+}
@@ -0,0 +1,278 @@
+/*
+ * path_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The list based A* implementation path_find() used up to NLarn 0.8.
+ * It is kept as the reference the benchmark compares the current
+ * implementation against, both for speed and for the paths found.
+ */
+
+#include "bench.h"
+#include "extdefs.h"
+#include "player.h"
+#include "spheres.h"
+
+typedef struct ref_element
+{
+    position pos;
+    guint32 g_score;
+    guint32 h_score;
+    struct ref_element* parent;
+} ref_element;
+
+typedef struct ref_path
+{
+    GPtrArray *closed;
+    GPtrArray *open;
+    position goal;
+} ref_path;
+
+static ref_element *ref_element_new(position pos)
+{
+    ref_element *lpe = g_malloc0(sizeof(ref_element));
+    lpe->pos = pos;
+
+    return lpe;
+}
+
+static void ref_path_destroy(ref_path *pt)
+{
+    for (guint idx = 0; idx < pt->open->len; idx++)
+        g_free(g_ptr_array_index(pt->open, idx));
+
+    g_ptr_array_free(pt->open, true);
+
+    for (guint idx = 0; idx < pt->closed->len; idx++)
+        g_free(g_ptr_array_index(pt->closed, idx));
+
+    g_ptr_array_free(pt->closed, true);
+    g_free(pt);
+}
+
+static guint ref_step_cost(map *m, const ref_element* element,
+    map_element_t map_elem, bool for_player)
+{
+    map_tile_t tt;
+    guint32 step_cost = 1;
+
+    if (for_player)
+        tt = player_memory_of(nlarn->p, element->pos).type ;
+    else
+        tt = map_tiletype_at(m, element->pos);
+
+    if (for_player && player_memory_of(nlarn->p, element->pos).trap)
+    {
+        const trap_t trap = map_trap_at(m, element->pos);
+        if (trap == TT_TELEPORT || trap == TT_TRAPDOOR)
+            step_cost += 50;
+        else
+            step_cost += 10;
+    }
+
+    monster *mon = map_get_monster_at(m, element->pos);
+    if (mon != NULL && (!for_player || monster_in_sight(mon)))
+        step_cost += 10;
+
+    switch (tt)
+    {
+    case LT_WATER:
+        if (map_elem == LE_SWIMMING_MONSTER || map_elem == LE_FLYING_MONSTER)
+            break;
+        /* else fall through */
+    case LT_FIRE:
+    case LT_CLOUD:
+        step_cost += 50;
+        break;
+    default:
+        break;
+    }
+
+    return step_cost;
+}
+
+static guint ref_cost(ref_element* element, position target)
+{
+    element->h_score = pos_distance(element->pos, target);
+
+    return element->g_score + element->h_score;
+}
+
+static ref_element *ref_element_in_list(const ref_element* el, const GPtrArray *list)
+{
+    for (guint idx = 0; idx < list->len; idx++)
+    {
+        ref_element *li = g_ptr_array_index(list, idx);
+
+        if (pos_identical(li->pos, el->pos))
+            return li;
+    }
+
+    return NULL;
+}
+
+static ref_element *ref_find_best(const ref_path *pt)
+{
+    ref_element *best = NULL;
+
+    for (guint idx = 0; idx < pt->open->len; idx++)
+    {
+        ref_element *el = g_ptr_array_index(pt->open, idx);
+
+        if (best == NULL || ref_cost(el, pt->goal) < ref_cost(best, pt->goal))
+            best = el;
+    }
+
+    return best;
+}
+
+static GPtrArray *ref_get_neighbours(map *m, position pos,
+                                     map_element_t element,
+                                     bool for_player,
+                                     position goal)
+{
+    GPtrArray *neighbours = g_ptr_array_new();
+
+    for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
+    {
+        if (dir == GD_CURR)
+            continue;
+
+        position new_pos = pos_move(pos, dir);
+
+        if (!pos_valid(new_pos))
+            continue;
+
+        if (pos_identical(new_pos, goal))
+        {
+            g_ptr_array_add(neighbours, ref_element_new(new_pos));
+            continue;
+        }
+
+        if (pos_identical(new_pos, nlarn->p->pos))
+            continue;
+
+        bool blocked_by_sphere = false;
+        for (guint i = 0; i < nlarn->spheres->len; i++)
+        {
+            sphere *s = g_ptr_array_index(nlarn->spheres, i);
+            if (pos_identical(s->pos, new_pos))
+            {
+                blocked_by_sphere = true;
+                break;
+            }
+        }
+        if (blocked_by_sphere)
+            continue;
+
+        if ((for_player && mt_is_passable(player_memory_of(nlarn->p, new_pos).type))
+                || (!for_player && monster_valid_dest(m, new_pos, element)))
+        {
+            g_ptr_array_add(neighbours, ref_element_new(new_pos));
+        }
+    }
+
+    return neighbours;
+}
+
+int path_find_reference(map *m, position start, position goal,
+                        map_element_t element, position *steps, int max_steps)
+{
+    if (Z(start) != Z(goal))
+        return -1;
+
+    ref_path *pt = g_malloc0(sizeof(ref_path));
+    pt->open   = g_ptr_array_new();
+    pt->closed = g_ptr_array_new();
+    pt->goal   = goal;
+
+    ref_element *curr = ref_element_new(start);
+    g_ptr_array_add(pt->open, curr);
+
+    bool for_player = pos_identical(start, nlarn->p->pos);
+
+    while (pt->open->len)
+    {
+        curr = ref_find_best(pt);
+
+        g_ptr_array_remove_fast(pt->open, curr);
+        g_ptr_array_add(pt->closed, curr);
+
+        if (pos_identical(curr->pos, pt->goal))
+        {
+            int len = 0;
+            for (ref_element *el = curr; el->parent != NULL; el = el->parent)
+                len++;
+
+            int idx = len;
+            for (ref_element *el = curr; el->parent != NULL; el = el->parent)
+            {
+                if (--idx < max_steps)
+                    steps[idx] = el->pos;
+            }
+
+            ref_path_destroy(pt);
+            return len;
+        }
+
+        GPtrArray *neighbours = ref_get_neighbours(m, curr->pos, element,
+                                                   for_player, pt->goal);
+
+        while (neighbours->len)
+        {
+            ref_element *next = g_ptr_array_remove_index_fast(neighbours,
+                                                neighbours->len - 1);
+
+            bool next_is_better = false;
+
+            if (ref_element_in_list(next, pt->closed))
+            {
+                g_free(next);
+                continue;
+            }
+
+            const guint32 next_g_score = curr->g_score
+                + ref_step_cost(m, next, element, for_player);
+
+            if (!ref_element_in_list(next, pt->open))
+            {
+                g_ptr_array_add(pt->open, next);
+                next_is_better = true;
+            }
+            else if (next->g_score > next_g_score)
+            {
+                next_is_better = true;
+            }
+            else
+            {
+                g_free(next);
+            }
+
+            if (next_is_better)
+            {
+                next->parent  = curr;
+                next->g_score = next_g_score;
+            }
+        }
+
+        g_ptr_array_free(neighbours, true);
+    }
+
+    ref_path_destroy(pt);
+
+    return -1;
+}
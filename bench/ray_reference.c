@@ -0,0 +1,102 @@
+/*
+ * ray_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The map_ray() used up to NLarn 0.8, which follows Bresenham's line
+ * algorithm step by step and appends every position to a GList. It is
+ * kept as the reference the benchmark compares the ray tables against.
+ */
+
+#include "bench.h"
+
+GList *map_ray_reference(map *m, position source, position target)
+{
+    GList *ray = NULL;
+    position pos = source;
+
+    /* Insert the source position */
+    ray = g_list_append(ray, GUINT_TO_POINTER(source.val));
+
+    int delta_x = abs(X(target) - X(source)) << 1;
+    int delta_y = abs(Y(target) - Y(source)) << 1;
+
+    /* if x1 == x2 or y1 == y2, then it does not matter what we set here */
+    int inc_x = X(target) > X(source) ? 1 : -1;
+    int inc_y = Y(target) > Y(source) ? 1 : -1;
+
+    if (delta_x >= delta_y)
+    {
+        /* error may go below zero */
+        int error = delta_y - (delta_x >> 1);
+
+        while (X(pos) != X(target))
+        {
+            if (error >= 0)
+            {
+                if (error || (inc_x > 0))
+                {
+                    Y(pos) += inc_y;
+                    error -= delta_x;
+                }
+            }
+
+            X(pos) += inc_x;
+            error += delta_y;
+
+            /* append even the last position to the list */
+            ray = g_list_append(ray, GUINT_TO_POINTER(pos.val));
+
+            if (!map_pos_transparent(m, pos))
+                break; /* stop following ray */
+        }
+    }
+    else
+    {
+        /* error may go below zero */
+        int error = delta_x - (delta_y >> 1);
+
+        while (Y(pos) != Y(target))
+        {
+            if (error >= 0)
+            {
+                if (error || (inc_y > 0))
+                {
+                    X(pos) += inc_x;
+                    error -= delta_y;
+                }
+            }
+
+            Y(pos) += inc_y;
+            error += delta_x;
+
+            /* append even the last position to the list */
+            ray = g_list_append(ray, GUINT_TO_POINTER(pos.val));
+
+            if (!map_pos_transparent(m, pos))
+                break; /* stop following ray */
+        }
+    }
+
+    if (ray && GPOINTER_TO_UINT(g_list_last(ray)->data) != target.val)
+    {
+        g_list_free(ray);
+        ray = NULL;
+    }
+
+    return ray;
+}
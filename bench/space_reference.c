@@ -0,0 +1,68 @@
+/*
+ * space_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The map_find_space_in() used up to NLarn 0.8, which walks the rectangle
+ * from a random starting point until a position passes map_pos_validate().
+ */
+
+#include "bench.h"
+#include "extdefs.h"
+#include "random.h"
+
+position map_find_space_reference(map *m,
+                                  rectangle where,
+                                  map_element_t element,
+                                  bool dead_end)
+{
+    position pos = pos_invalid;
+    int iteration = 0;
+
+    g_assert (m != NULL && element < LE_MAX);
+
+    X(pos) = rand_m_n(where.x1, where.x2);
+    Y(pos) = rand_m_n(where.y1, where.y2);
+    Z(pos) = m->nlevel;
+
+    /* number of positions inside the rectangle */
+    int count = (where.x2 - where.x1 + 1) * (where.y2 - where.y1 + 1);
+
+    do
+    {
+        X(pos)++;
+
+        if (X(pos) > where.x2)
+        {
+            X(pos) = where.x1;
+            Y(pos)++;
+        }
+
+        if (Y(pos) > where.y2)
+        {
+            Y(pos) = where.y1;
+        }
+
+        iteration++;
+    }
+    while (!map_pos_validate(m, pos, element, dead_end) && (iteration <= count));
+
+    if (iteration > count )
+        pos = pos_invalid;
+
+    return pos;
+}
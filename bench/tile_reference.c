@@ -0,0 +1,46 @@
+/*
+ * tile_reference.c
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
+ *
+ * NLarn is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * NLarn is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The map tiles as stored up to NLarn 0.8: one structure per tile holding
+ * all of its attributes. The benchmark copies the maps into this layout to
+ * compare scans over it with scans over the attribute planes.
+ */
+
+#include "bench.h"
+
+void map_tiles_reference(map_tile_reference grid[MAP_MAX_Y][MAP_MAX_X], map *m)
+{
+    for (int y = 0; y < MAP_MAX_Y; y++)
+    {
+        for (int x = 0; x < MAP_MAX_X; x++)
+        {
+            map_tile_reference *tile = &grid[y][x];
+
+            tile->type = m->type[y][x];
+            tile->base_type = m->base_type[y][x];
+            tile->timer = m->timer[y][x];
+            tile->sobject = m->sobject[y][x];
+            tile->trap = m->trap[y][x];
+            tile->spilltime = m->spilltime[y][x];
+            tile->m_oid = m->m_oid[y][x];
+            tile->ilist = m->ilist[y][x];
+            tile->spill = m->spill[y][x];
+        }
+    }
+}
@@ -1,6 +1,6 @@
 /*
  * fov.h
- * Copyright (C) 2009-2025 Joachim de Groot <jdegroot@web.de>
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
  *
  * NLarn is free software: you can redistribute it and/or modify it
  * under the terms of the GNU General Public License as published by the
@@ -37,6 +37,9 @@ typedef struct fov fov;
 fov *fov_new();
 
 /** @brief calculate the FOV for a map
+  *
+  * The visible fields are only recalculated if the position, the radius
+  * or the generation of the map differ from the previous calculation.
   *
   * @param fv pointer to a fov structure.
   * @param m the map
@@ -46,6 +49,18 @@ fov *fov_new();
   */
 void fov_calculate(fov *fv, map *m, position pos, int radius, bool infravision);
 
+/** @brief calculate a symmetric FOV for a map
+  *
+  * A transparent position is visible from pos if and only if pos is
+  * visible from it. The visible monsters are not determined.
+  *
+  * @param fv pointer to a fov structure.
+  * @param m the map
+  * @param pos the starting position
+  * @param radius the maximum distance along either axis
+  */
+void fov_calculate_symmetric(fov *fv, map *m, position pos, int radius);
+
 /** @brief check if a certain position is visible.
   *
   * @param fv pointer to a fov structure.
@@ -55,6 +70,16 @@ void fov_calculate(fov *fv, map *m, position pos, int radius, bool infravision);
   */
 bool fov_get(const fov *fv, position pos);
 
+/** @brief get the visibility of an entire row of positions.
+  *
+  * @param fv pointer to a fov structure.
+  * @param y the row.
+  *
+  * @return MAP_ROW_WORDS words; position x is visible if bit
+  *         x % MAP_WORD_BITS of word x / MAP_WORD_BITS is set.
+  */
+const guint64 *fov_row(const fov *fv, int y);
+
 /** @brief set visibility for a certain position.
   *
   * @param fv pointer to a fov structure.
@@ -79,6 +104,21 @@ void fov_reset(fov *fv);
   */
 monster *fov_get_closest_monster(fov *fv);
 
+/** @brief Get the number of visible monsters.
+  *
+  * @param fv pointer to a fov structure
+  * @return the number of visible monsters
+  */
+guint fov_visible_monster_count(const fov *fv);
+
+/** @brief Get a visible monster without allocating a list.
+  *
+  * @param fv pointer to a fov structure
+  * @param idx the index of the monster, the closest monster being at 0
+  * @return the monster, or NULL if idx is beyond the last monster
+  */
+monster *fov_visible_monster(const fov *fv, guint idx);
+
 /** @brief Get a list of all visible monsters
   *
   * @param fv A pointer to a fov structure
@@ -31,7 +31,7 @@ extern const guint MOBUL;
 extern const guint TIMELIMIT;
 
 /* internal counter for save file compatibility */
-#define SAVEFILE_VERSION    28
+#define SAVEFILE_VERSION    29
 
 /* forward declarations */
 struct game_config;
@@ -118,6 +118,12 @@ game *game_destroy(game *g);
  */
 int game_save(game *g);
 
+/**
+ * @brief Return a level of the dungeon. Levels which have not been
+ *        entered before are generated on the first call.
+ * @param g The game
+ * @param nmap The number of the level
+ */
 map *game_map(game *g, guint nmap);
 void game_spin_the_wheel(game *g);
 void game_remove_dead_monsters(game *g);
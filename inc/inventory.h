@@ -134,6 +134,14 @@ bool inv_del_oid(inventory **inv, gpointer oid);
 void inv_erode(inventory **inv, item_erosion_type iet,
     bool visible, int (*ifilter)(item *));
 
+/**
+ * Function to determine if any inventory has been altered.
+ *
+ * @return the number of times items have been added to or removed
+ *         from any inventory; wraps around on overflow
+ */
+guint32 inv_changes();
+
 /**
  * Function to determine the count of items in an inventory.
  *
@@ -34,6 +34,13 @@
 #define MAP_MAX_Y 17
 #define MAP_SIZE MAP_MAX_X*MAP_MAX_Y
 
+/* bitplanes store one bit per tile in rows of 64-bit words */
+#define MAP_WORD_BITS 64
+#define MAP_ROW_WORDS ((MAP_MAX_X + MAP_WORD_BITS - 1) / MAP_WORD_BITS)
+
+/* the maximum number of positions on a ray */
+#define MAP_RAY_MAX MAP_MAX_X
+
 /* number of levels */
 #define MAP_CMAX 11                   /* max # levels in the caverns */
 #define MAP_VMAX  3                   /* max # of levels in the temple of the luran */
@@ -73,20 +80,6 @@ typedef enum map_element_type
     LE_MAX
 } map_element_t;
 
-typedef struct map_tile
-{
-    guint64
-        type:       8,
-        base_type:  8, /* if tile is covered with e.g. fire the original type is stored here */
-        timer:      8, /* countdown to when the type will become base_type again */
-        sobject:    8, /* something special located on this tile */
-        trap:       8, /* trap located on this tile */
-        spilltime:  8; /* countdown for the time the spilled liquid is visible */
-    gpointer m_oid;    /* id of monster located on this tile */
-    inventory *ilist;  /* items located on this tile */
-    colour_t spill;    /* colour of the liquid spilled here */
-} map_tile;
-
 typedef struct map_tile_data
 {
     map_tile_t tile;
@@ -103,11 +96,53 @@ typedef struct map
     guint32 nlevel;                       /* map number */
     guint32 visited;                      /* last time player has been on this map */
     guint32 mcount;                       /* monster count */
-    map_tile grid[MAP_MAX_Y][MAP_MAX_X];  /* the map */
+
+    /* the tiles of the map, one plane per attribute: the attributes read
+       by the scans over the entire map come first, the rarely used ones
+       are kept apart from them */
+    guint8 type[MAP_MAX_Y][MAP_MAX_X];      /* map_tile_t */
+    guint8 sobject[MAP_MAX_Y][MAP_MAX_X];   /* something special located here */
+    guint8 trap[MAP_MAX_Y][MAP_MAX_X];      /* trap located here */
+    guint8 timer[MAP_MAX_Y][MAP_MAX_X];     /* countdown to when the type will become base_type again */
+    guint8 base_type[MAP_MAX_Y][MAP_MAX_X]; /* if tile is covered with e.g. fire the original type is stored here */
+    guint8 spilltime[MAP_MAX_Y][MAP_MAX_X]; /* countdown for the time the spilled liquid is visible */
+    colour_t spill[MAP_MAX_Y][MAP_MAX_X];   /* colour of the liquid spilled here */
+    gpointer m_oid[MAP_MAX_Y][MAP_MAX_X];   /* id of monster located here */
+    inventory *ilist[MAP_MAX_Y][MAP_MAX_X]; /* items located here */
+
+    guint64 transparent[MAP_MAX_Y][MAP_ROW_WORDS];      /* see-through tiles */
+    guint64 passable[LE_MAX][MAP_MAX_Y][MAP_ROW_WORDS]; /* by map_element_t */
+    guint64 candidates[LE_MAX][MAP_MAX_Y][MAP_ROW_WORDS]; /* tiles map_find_space() may return */
+    guint8 components_valid;              /* bitmask of up-to-date labels */
+    guint16 components[LE_MAX][MAP_MAX_Y][MAP_MAX_X]; /* connected areas */
+    guint32 generation;                   /* stamp of the last change */
+    guint64 active[MAP_MAX_Y][MAP_ROW_WORDS]; /* tiles with a timer or spill */
+    guint16 active_count;                 /* number of bits set in active */
 } map;
 
-/* callback function for trajectories */
-typedef bool (*trajectory_hit_sth)(const GList *trajectory,
+/* statistics of the level generation, shown in wizard mode */
+typedef struct map_generation_stats
+{
+    guint32 levels;        /* levels generated */
+    guint32 mazes;         /* mazes carved */
+    guint32 restarts;      /* predefined levels without space for the
+                              stationary objects, generated again */
+    guint32 maze_restarts; /* mazes without space for the stationary
+                              objects, carved again */
+    guint32 rejections;    /* mazes with unreachable parts */
+    guint32 tunnels;       /* tunnels carved to connect unreachable parts */
+    gint64 carve_time;     /* time spent carving the corridors of mazes
+                              (microseconds) */
+    guint32 validations;   /* mazes checked for unreachable parts */
+    gint64 validate_time;  /* time spent checking mazes for unreachable
+                              parts (microseconds) */
+    gint64 time;           /* time spent generating levels (microseconds) */
+    gint64 time_max;       /* the longest time a level took (microseconds) */
+} map_generation_stats;
+
+/* callback function for trajectories; the affected position is
+   trajectory[step], the positions before it are those already passed */
+typedef bool (*trajectory_hit_sth)(const position *trajectory, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
 
@@ -121,13 +156,46 @@ typedef enum {
 
 /* function declarations */
 
+/**
+ * @brief Load and validate the predefined levels.
+ *
+ * @param mazefile the name of the file containing the predefined levels
+ * @return NULL on success, otherwise a newly allocated error message
+ */
+char *map_mazes_load(const char *mazefile);
+
 map *map_new(int num, const char *mazefile);
+
+/**
+ * @brief Choose how mazes with unreachable parts are dealt with.
+ *
+ * @param repair true to connect the parts, false to carve new mazes
+ *        until all parts can be reached
+ */
+void map_generation_set_repair(bool repair);
+
+/**
+ * @brief Statistics of all levels generated since the program started.
+ */
+const map_generation_stats *map_generation_stats_get();
+
+/**
+ * @brief Describe the level generation statistics.
+ *
+ * @return A newly allocated string.
+ */
+char *map_generation_stats_describe();
 void map_destroy(map *m);
 
 cJSON *map_serialize(map *m);
 map *map_deserialize(cJSON *mser);
 char *map_dump(map *m, position ppos);
 
+/* Update the transparency and passability of a tile after its type or
+   stationary object have been changed. This also stamps the map with a
+   new generation, which is unique among all maps. */
+void map_tile_changed(map *m, position pos);
+
 position map_find_space(map *m, map_element_t element,
                         bool dead_end);
 
@@ -166,6 +234,19 @@ int map_pos_is_visible(map *m, position source, position target);
  */
 GList *map_ray(map *m, position source, position target);
 
+/**
+ * Fill a buffer with every position between two points.
+ *
+ * @param m The map that contains both positions.
+ * @param source The starting position.
+ * @param target The destination.
+ * @param ray A buffer for at least MAP_RAY_MAX positions.
+ *
+ * @return The number of positions including source and target,
+ *         0 if the ray is blocked before reaching the target.
+ */
+guint map_ray_fill(map *m, position source, position target, position *ray);
+
 /**
  * Follow a ray from target to destination.
  *
@@ -257,89 +338,109 @@ extern const char *map_names[MAP_MAX];
 
 /* inline accessor functions */
 
-static inline map_tile *map_tile_at(map *m, const position pos)
-{
-    g_assert(m != NULL && pos_valid(pos));
-    return &m->grid[Y(pos)][X(pos)];
-}
-
 static inline inventory **map_ilist_at(map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return &m->grid[Y(pos)][X(pos)].ilist;
+    return &m->ilist[Y(pos)][X(pos)];
 }
 
 static inline map_tile_t map_tiletype_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].type;
+    return m->type[Y(pos)][X(pos)];
 }
 
 static inline void map_tiletype_set(map *m, const position pos, const map_tile_t type)
 {
     g_assert(m != NULL && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].type = type;
+    m->type[Y(pos)][X(pos)] = type;
+    map_tile_changed(m, pos);
 }
 
 static inline map_tile_t map_basetype_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].base_type;
+    return m->base_type[Y(pos)][X(pos)];
 }
 
 static inline void map_basetype_set(map *m, const position pos, const map_tile_t type)
 {
     g_assert(m != NULL && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].base_type = type;
+    m->base_type[Y(pos)][X(pos)] = type;
+}
+
+/* mark a tile for processing by map_timer() */
+static inline void map_tile_activate(map *m, const position pos)
+{
+    const guint64 bit = (guint64)1 << (X(pos) % MAP_WORD_BITS);
+    guint64 *word = &m->active[Y(pos)][X(pos) / MAP_WORD_BITS];
+
+    if (!(*word & bit))
+    {
+        *word |= bit;
+        m->active_count++;
+    }
 }
 
 static inline guint8 map_timer_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].timer;
+    return m->timer[Y(pos)][X(pos)];
+}
+
+static inline void map_timer_set(map *m, const position pos, const guint8 timer)
+{
+    g_assert(m != NULL && pos_valid(pos));
+    m->timer[Y(pos)][X(pos)] = timer;
+
+    if (timer)
+        map_tile_activate(m, pos);
 }
 
 static inline trap_t map_trap_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].trap;
+    return m->trap[Y(pos)][X(pos)];
 }
 
 static inline void map_trap_set(map *m, const position pos, const trap_t type)
 {
     g_assert(m != NULL && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].trap = type;
+    m->trap[Y(pos)][X(pos)] = type;
+    map_tile_changed(m, pos);
 }
 
 static inline colour_t map_spill_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].spill;
+    return m->spill[Y(pos)][X(pos)];
 }
 
 static inline void map_spill_set(map *m, const position pos, const colour_t colour)
 {
     g_assert(m != NULL && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].spill = colour;
-    m->grid[Y(pos)][X(pos)].spilltime = 20;
+    m->spill[Y(pos)][X(pos)] = colour;
+    m->spilltime[Y(pos)][X(pos)] = 20;
+    map_tile_activate(m, pos);
 }
 
 static inline sobject_t map_sobject_at(const map *m, const position pos)
 {
     g_assert(m != NULL && pos_valid(pos));
-    return m->grid[Y(pos)][X(pos)].sobject;
+    return m->sobject[Y(pos)][X(pos)];
 }
 
 static inline void map_sobject_set(map *m, const position pos, const sobject_t type)
 {
     g_assert(m != NULL && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].sobject = type;
+    m->sobject[Y(pos)][X(pos)] = type;
+    map_tile_changed(m, pos);
 }
 
 static inline void map_set_monster_at(map *m, const position pos, monster *monst)
 {
     g_assert(m != NULL && m->nlevel == Z(pos) && pos_valid(pos));
-    m->grid[Y(pos)][X(pos)].m_oid = (monst != NULL) ? monster_oid(monst) : NULL;
+    m->m_oid[Y(pos)][X(pos)] = (monst != NULL) ? monster_oid(monst) : NULL;
 }
 
 static inline bool map_is_monster_at(map *m, const position pos)
@@ -391,16 +492,34 @@ static inline const char *map_name(map *m)
     return map_names[m->nlevel];
 }
 
+static inline bool map_transparent_at(const map *m, int x, int y)
+{
+    return (m->transparent[y][x / MAP_WORD_BITS] >> (x % MAP_WORD_BITS)) & 1;
+}
+
+static inline bool map_passable_at(const map *m, int x, int y,
+                                   map_element_t element)
+{
+    return (m->passable[element][y][x / MAP_WORD_BITS]
+            >> (x % MAP_WORD_BITS)) & 1;
+}
+
 static inline bool map_pos_transparent(const map *m, const position pos)
 {
-    return mt_is_transparent(m->grid[Y(pos)][X(pos)].type)
-        && so_is_transparent(m->grid[Y(pos)][X(pos)].sobject);
+    return map_transparent_at(m, X(pos), Y(pos));
+}
+
+/* check if the tile can be entered by something moving like element,
+   regardless of what currently occupies it */
+static inline bool map_pos_passable_by(const map *m, const position pos,
+                                       map_element_t element)
+{
+    return map_passable_at(m, X(pos), Y(pos), element);
 }
 
 static inline bool map_pos_passable(const map *m, const position pos)
 {
-    return mt_is_passable(m->grid[Y(pos)][X(pos)].type)
-        && so_is_passable(m->grid[Y(pos)][X(pos)].sobject);
+    return map_passable_at(m, X(pos), Y(pos), LE_MONSTER);
 }
 
 #endif
@@ -163,6 +163,9 @@ DECLARE_ENUM(monster_action_t, MONSTER_ACTION_TYPE_ENUM)
 
 #define MONSTER_FLAG_COUNT 21
 
+/* the widest visibility range of any monster, see monster_new() */
+#define MONSTER_VISRANGE_MAX 11
+
 DECLARE_ENUM(monster_flag, MONSTER_FLAG_ENUM)
 
 /* function definitions */
@@ -320,6 +323,8 @@ int monster_type_size(monster_t type);
 int monster_type_speed(monster_t type);
 int monster_type_flags(monster_t type, monster_flag f);
 int monster_type_hp_max(monster_t type);
+/* the visibility range of monsters of a type */
+int monster_type_visrange(monster_t type);
 char monster_type_glyph(monster_t type);
 int monster_type_reroll_chance(monster_t type);
 
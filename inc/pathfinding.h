@@ -30,13 +30,14 @@ typedef struct path_element
     guint32 g_score;
     guint32 h_score;
     struct path_element* parent;
+    map_tile_t tile;    /* the player's memory of the tile when found */
+    trap_t trap;        /* the trap known to the player when found */
 } path_element;
 
 typedef struct path
 {
-    GQueue *path;
-    GPtrArray *closed;
-    GPtrArray *open;
+    GQueue *path;           /* the steps towards the goal */
+    path_element *steps;    /* storage for the elements in path */
     position start;
     position goal;
 } path;
@@ -53,6 +54,149 @@ typedef struct path
 path *path_find(map *m, position start, position goal,
                 map_element_t element);
 
+/**
+ * @brief Find a path between two positions without allocating memory.
+ *
+ * @param m the map to work on
+ * @param start the starting position
+ * @param goal the destination
+ * @param element the map_element_t that can be travelled
+ * @param steps the buffer receiving the first steps of the path, the
+ *        starting position not included
+ * @param capacity the number of positions steps can hold
+ * @return the length of the entire path, which may exceed capacity, or -1
+ *         if none could be found
+ */
+gint path_find_steps(map *m, position start, position goal,
+                     map_element_t element, position *steps, guint capacity);
+
+/**
+ * @brief Determine the first step of the path between two positions.
+ *
+ * @param m the map to work on
+ * @param start the starting position
+ * @param goal the destination
+ * @param element the map_element_t that can be travelled
+ * @return the first step or pos_invalid if there is no path or start
+ *         is the goal
+ */
+position path_find_step(map *m, position start, position goal,
+                        map_element_t element);
+
+/**
+ * @brief Check if a path found for the player can still be followed.
+ *
+ * This is the case while the player stands on the position the path's
+ * next step leads away from, the player's memory of the remaining steps
+ * has not changed since the path has been found, no new trap has become
+ * known on them and no visible monster blocks them.
+ *
+ * @param pth a path found for the player by <path_find>"()"
+ * @return true if the next step of the path can be taken
+ */
+bool path_player_route_valid(path *pth);
+
+/**
+ * @brief Determine the next step towards a target many walkers head for.
+ *
+ * The costs of reaching the target are calculated once per turn for all
+ * walkers of the same map_element_t, using the weights of <path_find>"()".
+ * Further walkers just compare the costs of their neighbouring tiles.
+ *
+ * @param m the map to work on
+ * @param pos the walker's current position
+ * @param target the destination
+ * @param element the map_element_t that can be travelled
+ * @return the next position or pos if the target can not be reached
+ */
+position path_field_next_step(map *m, position pos, position target,
+                              map_element_t element);
+
+/**
+ * @brief Determine the next step away from a target many walkers flee from.
+ *
+ * Uses the distance field of <path_field_next_step>"()" turned into a flee
+ * field, which leads away from the target without running into dead ends.
+ *
+ * @param m the map to work on
+ * @param pos the walker's current position
+ * @param target the position to flee from
+ * @param element the map_element_t that can be travelled
+ * @return the next position, pos if staying is safest or pos_invalid if
+ *         pos is not covered by the field
+ */
+position path_field_flee_step(map *m, position pos, position target,
+                              map_element_t element);
+
+/**
+ * @brief Discard all distance fields, e.g. when the game ends.
+ */
+void path_fields_clear();
+
+/**
+ * @brief Find a path to the nearest of several goals in a single search.
+ *
+ * @param m the map to work on
+ * @param start the starting position
+ * @param goals the possible destinations; those on other maps are ignored
+ * @param count the number of goals
+ * @param element the map_element_t that can be travelled
+ * @return a path to the goal that is cheapest to reach, which is stored in
+ *         the path's goal, or NULL if none can be reached
+ */
+path *path_find_nearest(map *m, position start, const position *goals,
+                        guint count, map_element_t element);
+
+/**
+ * @brief Determine the first step towards the nearest of several goals.
+ *
+ * The allocation-free variant of <path_find_nearest>"()".
+ *
+ * @param m the map to work on
+ * @param start the starting position
+ * @param goals the possible destinations; those on other maps are ignored
+ * @param count the number of goals
+ * @param element the map_element_t that can be travelled
+ * @param step if not NULL, receives the first step or pos_invalid if
+ *        start is the goal reached
+ * @return the index of the goal reached or -1 if none can be reached
+ */
+gint path_find_nearest_step(map *m, position start, const position *goals,
+                            guint count, map_element_t element,
+                            position *step);
+
+/**
+ * @brief Find the player's path, repairing the previous search if possible.
+ *
+ * As long as the map and the goal stay the same, the search of the
+ * previous call is reused. Only the parts affected by tiles the player's
+ * memory of which has changed, and by visible monsters and spheres, are
+ * searched again.
+ *
+ * @param m the map to work on
+ * @param start the player's position
+ * @param goal the destination
+ * @return a path or NULL if none could be found
+ */
+path *path_find_incremental(map *m, position start, position goal);
+
+/**
+ * @brief The number of nodes expanded by the last search, for benchmarks.
+ */
+guint path_expansions();
+
+/**
+ * @brief Find the player's way to a position which may be on another map.
+ *
+ * Journeys to other maps are planned over the map exits known to the
+ * player. Only the path on the player's current map is determined.
+ *
+ * @param goal the destination
+ * @return the path on the player's map leading to the goal or to the exit
+ *         to take next, NULL if the player knows no way to the goal
+ */
+path *path_find_journey(position goal);
+
 /**
  * @brief Free memory allocated for a given path.
  *
@@ -168,9 +168,18 @@ typedef struct player
     /* player's field of vision */
     fov *fv;
 
+    /* the positions the player can be seen from */
+    fov *sightlines;
+
     /* player's memory of the map */
     player_tile_memory memory[MAP_MAX][MAP_MAX_Y][MAP_MAX_X];
 
+    /* the field of vision, map generation and inventory changes at the
+       last update of the memory; unchanged tiles are not updated again */
+    guint64 memory_fov[MAP_MAX_Y][MAP_ROW_WORDS];
+    guint32 memory_generation;
+    guint32 memory_inv_changes;
+
     /* remembered positions of stationary objects */
     GArray *sobjmem;
 
@@ -266,6 +275,30 @@ int player_move(player *p, direction dir, bool open_door);
 int player_attack(player *p, monster *m);
 void player_update_fov(player *p);
 
+/**
+  * @brief Erase the player's memory of a map.
+  *
+  * Tiles visible at the next update of the field of vision are
+  * memorized again.
+  *
+  * @param p The player.
+  * @param nlevel The number of the map to forget.
+  */
+void player_memory_forget(player *p, int nlevel);
+
+/**
+  * @brief Determine if the player can be seen from a position.
+  *
+  * The sight lines are symmetric and calculated once per position
+  * of the player, covering the visibility range of all monsters.
+  *
+  * @param p The player.
+  * @param pos The position of the beholder.
+  *
+  * @return true if there is a clear line of sight.
+  */
+bool player_seen_from(player *p, position pos);
+
 /**
  * Function to enter a map.
  *
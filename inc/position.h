@@ -61,13 +61,17 @@ typedef struct rectangle
     guint64 y2: 16;
 } rectangle;
 
+/* areas store one bit per point in rows of 64-bit words */
+#define AREA_WORD_BITS 64
+
 typedef struct area
 {
     gint16 start_x;
     gint16 start_y;
     gint16 size_x;
     gint16 size_y;
-    int **area;
+    gint16 row_words; /* number of words per row */
+    guint64 *points;  /* size_y rows of row_words words */
 } area;
 
 #define X(pos) ((pos).bf.x)
@@ -74,8 +74,8 @@ char *potion_desc(potion_t potion_id);
 colour_t potion_colour(potion_t potion_id);
 int potion_throw(struct player *p);
 item_usage_result potion_quaff(struct player *p, item *potion);
-bool potion_pos_hit(const GList *traj, const damage_originator *damo,
-    gpointer data1, gpointer data2);
+bool potion_pos_hit(const position *traj, guint step,
+    const damage_originator *damo, gpointer data1, gpointer data2);
 
 /* external vars */
 
@@ -131,8 +131,8 @@ extern const weapon_data weapons[WT_MAX];
  */
 int  weapon_fire(struct player *p, position target);
 void weapon_swap(struct player *p);
-bool weapon_throw_pos_hit(const GList *traj, const damage_originator *damo,
-    gpointer data1, gpointer data2);
+bool weapon_throw_pos_hit(const position *traj, guint step,
+    const damage_originator *damo, gpointer data1, gpointer data2);
 
 /**
  * @brief Return a shortened description of a given weapon
@@ -193,19 +193,12 @@ static int exec_approach(player *p, position pos, position *tt __attribute__((un
 {
     /* step one tile towards the target, routing around walls */
     map *cmap = game_map(nlarn, Z(p->pos));
-    path *pth = path_find(cmap, p->pos, pos, LE_GROUND);
-    int turns = 0;
+    position step = path_find_step(cmap, p->pos, pos, LE_GROUND);
 
-    if (pth != NULL && !g_queue_is_empty(pth->path))
-    {
-        path_element *el = g_queue_pop_head(pth->path);
-        turns = player_move(p, pos_dir(p->pos, el->pos), true);
-    }
-
-    if (pth != NULL)
-        path_destroy(pth);
+    if (!pos_valid(step))
+        return 0;
 
-    return turns;
+    return player_move(p, pos_dir(p->pos, step), true);
 }
 
 static int exec_fire(player *p, position pos, position *tt __attribute__((unused)))
@@ -1,6 +1,6 @@
 /*
  * fov.c
- * Copyright (C) 2009-2025 Joachim de Groot <jdegroot@web.de>
+ * Copyright (C) 2009-2026 Joachim de Groot <jdegroot@web.de>
  *
  * NLarn is free software: you can redistribute it and/or modify it
  * under the terms of the GNU General Public License as published by the
@@ -24,38 +24,80 @@
 #include "extdefs.h"
 #include "position.h"
 
-static void fov_calculate_octant(fov *fv, map *m, position center,
-                                 bool infravision, int row,
-                                 float start, float end, int radius,
+static void fov_calculate_octant(fov *fv, map *m, position center, int row,
+                                 int start_n, int start_d,
+                                 int end_n, int end_d, int radius,
                                  int xx, int xy, int yx, int yy);
 
-static gint fov_visible_monster_sort(gconstpointer a, gconstpointer b, gpointer center);
+static bool fov_scan_repeated(int row, int start_n, int start_d,
+                              int end_n, int end_d);
+
+static void fov_calculate_quadrant(fov *fv, map *m, position center,
+                                   int depth, int start_n, int start_d,
+                                   int end_n, int end_d, int radius,
+                                   int cx, int rx, int cy, int ry);
+
+static void fov_collect_monsters(fov *fv, map *m, int radius,
+                                 bool infravision);
+
+static void fov_monster_add(fov *fv, monster *mon, bool check_duplicate);
 
 struct fov
 {
-    /* the actual field of vision */
-    guchar data[MAP_MAX_Y][MAP_MAX_X];
+    /* the actual field of vision, a bitplane like those of the map */
+    guint64 data[MAP_MAX_Y][MAP_ROW_WORDS];
 
     /* the center of the fov */
     position center;
 
-    /* The list of visible monsters - it's a hash as fields may get visited
-       twice, which means that monsters may get added to the list multiple
-       times. The hash overwrites duplicate values. */
-    GHashTable *mlist;
+    /* the radius, mode and map generation the fov has been calculated
+       for; a generation of zero requires the fov to be recalculated */
+    int radius;
+    bool symmetric;
+    guint32 generation;
+
+    /* The visible monsters, ordered by their distance from the center.
+       Each fov_monster caches the distance of its monster. */
+    GArray *mlist;
 };
 
+typedef struct fov_monster
+{
+    monster *m;
+    int distance;
+} fov_monster;
+
+/* The scans of an octant already done, an open addressing hash of their
+   parameters. A slot is empty unless its stamp is the current one. */
+#define FOV_SCAN_SLOTS 4096
+
+static struct
+{
+    guint64 key[FOV_SCAN_SLOTS];
+    guint32 stamp[FOV_SCAN_SLOTS];
+    guint32 current;
+    guint count;
+} fov_scans;
+
+static inline void fov_bit_set(fov *fv, int x, int y)
+{
+    fv->data[y][x / MAP_WORD_BITS] |= (guint64)1 << (x % MAP_WORD_BITS);
+}
+
 fov *fov_new()
 {
     fov *new_fov = g_new0(fov, 1);
     new_fov->center = pos_invalid;
-    new_fov->mlist = g_hash_table_new(g_direct_hash, g_direct_equal);
+    new_fov->mlist = g_array_new(false, false, sizeof(fov_monster));
 
     return new_fov;
 }
-/* this and the function fov_calculate_octant() have been
- * ported from python to c using the example at
+/* Recursive shadowcasting as described at
  * http://roguebasin.roguelikedevelopment.org/index.php?title=Python_shadowcasting_implementation
+ * The slopes are kept as fractions of integers, thus no floating point
+ * arithmetic is required. As in the original port, every square that is
+ * not blocked starts a child scan; scans repeated within an octant are
+ * skipped. Visible monsters are collected afterwards.
  */
 void fov_calculate(fov *fv, map *m, position pos, int radius, bool infravision)
 {
@@ -67,22 +109,89 @@ void fov_calculate(fov *fv, map *m, position pos, int radius, bool infravision)
         { 1,  0,  0,  1, -1,  0,  0, -1 }
     };
 
+    /* The visible fields remain the same unless the beholder has moved
+       or the map has been altered, thus only the list of visible
+       monsters needs to be updated. */
+    if (fv->generation != 0 && fv->generation == m->generation
+            && fv->radius == radius && !fv->symmetric
+            && pos_identical(fv->center, pos))
+    {
+        g_array_set_size(fv->mlist, 0);
+        fov_collect_monsters(fv, m, radius, infravision);
+
+        return;
+    }
+
     /* reset the entire fov to unseen */
     fov_reset(fv);
 
     /* set the center of the fov */
     fv->center = pos;
+    fv->radius = radius;
+    fv->symmetric = false;
+    fv->generation = m->generation;
 
     /* determine which fields are visible */
     for (int octant = 0; octant < 8; octant++)
     {
-        fov_calculate_octant(fv, m, pos, infravision,
-                             1, 1.0f, 0.0f, radius,
+        /* forget the scans of the previous octant */
+        if (++fov_scans.current == 0)
+        {
+            memset(fov_scans.stamp, 0, sizeof(fov_scans.stamp));
+            fov_scans.current = 1;
+        }
+        fov_scans.count = 0;
+
+        fov_calculate_octant(fv, m, pos, 1, 1, 1, 0, 1, radius,
                              mult[0][octant], mult[1][octant],
                              mult[2][octant], mult[3][octant]);
     }
 
-    fov_set(fv, pos, true, infravision, true);
+    fov_bit_set(fv, X(pos), Y(pos));
+
+    fov_collect_monsters(fv, m, radius, infravision);
+}
+
+/* Symmetric shadowcasting as described at
+ * https://www.albertford.com/shadowcasting/
+ * The map is scanned in four quadrants row by row, the depth of a row
+ * being its distance from the center. A transparent field is only lit if
+ * its center lies within the beam, which makes the sight lines symmetric.
+ */
+void fov_calculate_symmetric(fov *fv, map *m, position pos, int radius)
+{
+    /* the x and y offsets per column and row of the quadrants
+       north, east, south and west */
+    const int mult[4][4] =
+    {
+        { 1,  0,  0, -1 },
+        { 0,  1,  1,  0 },
+        { 1,  0,  0,  1 },
+        { 0, -1,  1,  0 },
+    };
+
+    if (fv->generation != 0 && fv->generation == m->generation
+            && fv->radius == radius && fv->symmetric
+            && pos_identical(fv->center, pos))
+    {
+        return;
+    }
+
+    fov_reset(fv);
+
+    fv->center = pos;
+    fv->radius = radius;
+    fv->symmetric = true;
+    fv->generation = m->generation;
+
+    for (int quadrant = 0; quadrant < 4; quadrant++)
+    {
+        fov_calculate_quadrant(fv, m, pos, 1, -1, 1, 1, 1, radius,
+                               mult[quadrant][0], mult[quadrant][1],
+                               mult[quadrant][2], mult[quadrant][3]);
+    }
+
+    fov_bit_set(fv, X(pos), Y(pos));
 }
 
 bool fov_get(const fov *fv, position pos)
@@ -90,7 +199,16 @@ bool fov_get(const fov *fv, position pos)
     g_assert (fv != NULL);
     g_assert (pos_valid(pos));
 
-    return fv->data[Y(pos)][X(pos)];
+    return (fv->data[Y(pos)][X(pos) / MAP_WORD_BITS]
+            >> (X(pos) % MAP_WORD_BITS)) & 1;
+}
+
+const guint64 *fov_row(const fov *fv, int y)
+{
+    g_assert (fv != NULL);
+    g_assert (y >= 0 && y < MAP_MAX_Y);
+
+    return fv->data[y];
 }
 
 void fov_set(fov *fv, position pos, guchar visible,
@@ -99,7 +217,16 @@ void fov_set(fov *fv, position pos, guchar visible,
     g_assert (fv != NULL);
     g_assert (pos_valid(pos));
 
-    fv->data[Y(pos)][X(pos)] = visible;
+    const guint64 bit = (guint64)1 << (X(pos) % MAP_WORD_BITS);
+
+    /* the fov does no longer match the map */
+    fv->generation = 0;
+
+    if (visible)
+        fv->data[Y(pos)][X(pos) / MAP_WORD_BITS] |= bit;
+    else
+        fv->data[Y(pos)][X(pos) / MAP_WORD_BITS] &= ~bit;
+
     monster *mon;
 
     /* If advised to do so, check if there is a monster at that
@@ -109,8 +236,9 @@ void fov_set(fov *fv, position pos, guchar visible,
         && !monster_unknown(mon)
         && (!monster_flags(mon, INVISIBLE) || infravision))
     {
-        /* found a visible monster -> add it to the list */
-        g_hash_table_insert(fv->mlist, mon, 0);
+        /* found a visible monster -> add it to the list, as fields may
+           get set twice, the monster may already be there */
+        fov_monster_add(fv, mon, true);
     }
 }
 
@@ -119,50 +247,48 @@ void fov_reset(fov *fv)
     g_assert (fv != NULL);
 
     /* set fov_data to false */
-    memset(fv->data, 0, MAP_MAX_Y * MAP_MAX_X * sizeof(guchar));
+    memset(fv->data, 0, sizeof(fv->data));
 
     /* set the center to an invalid position */
     fv->center = pos_invalid;
+    fv->generation = 0;
 
     /* clean list of visible monsters */
-    g_hash_table_remove_all(fv->mlist);
+    g_array_set_size(fv->mlist, 0);
 }
 
 monster *fov_get_closest_monster(fov *fv)
 {
-    monster *closest_monster = NULL;
+    g_assert (fv != NULL);
 
-    if (g_hash_table_size(fv->mlist) > 0)
-    {
-        /* get the list of all visible monsters */
-        GList *mlist = g_hash_table_get_keys(fv->mlist);
+    /* the list is ordered by distance */
+    return fov_visible_monster(fv, 0);
+}
+
+guint fov_visible_monster_count(const fov *fv)
+{
+    g_assert (fv != NULL);
 
-        /* sort the monsters list by distance */
-        mlist = g_list_sort_with_data(mlist, fov_visible_monster_sort,
-                                      &fv->center);
+    return fv->mlist->len;
+}
 
-        /* get the first element in the list */
-        closest_monster = mlist->data;
+monster *fov_visible_monster(const fov *fv, guint idx)
+{
+    g_assert (fv != NULL);
 
-        g_list_free(mlist);
-    }
+    if (idx >= fv->mlist->len)
+        return NULL;
 
-    return closest_monster;
+    return g_array_index(fv->mlist, fov_monster, idx).m;
 }
 
 GList *fov_get_visible_monsters(fov *fv)
 {
     GList *mlist = NULL;
 
-    if (g_hash_table_size(fv->mlist) != 0)
-    {
-        /* get a GList of all visible monster all */
-        mlist = g_hash_table_get_keys(fv->mlist);
-
-        /* sort the list of monster by distance */
-        mlist = g_list_sort_with_data(mlist, fov_visible_monster_sort,
-                                      &fv->center);
-    }
+    /* prepend from the end to keep the order */
+    for (guint idx = fv->mlist->len; idx > 0; idx--)
+        mlist = g_list_prepend(mlist, fov_visible_monster(fv, idx - 1));
 
     return mlist;
 }
@@ -172,95 +298,96 @@ void fov_free(fov *fv)
     g_assert (fv != NULL);
 
     /* free the allocated memory */
-    g_hash_table_destroy(fv->mlist);
+    g_array_free(fv->mlist, true);
     g_free(fv);
 }
 
-static void fov_calculate_octant(fov *fv, map *m, position center,
-                                 bool infravision, int row,
-                                 float start, float end, int radius,
+/* A slope n/d is compared to another by cross multiplication, which
+   requires the denominators to be positive. */
+static void fov_calculate_octant(fov *fv, map *m, position center, int row,
+                                 int start_n, int start_d,
+                                 int end_n, int end_d, int radius,
                                  int xx, int xy, int yx, int yy)
 {
-    float new_start = 0;
+    int new_start_n = 0, new_start_d = 1;
+
+    if (start_n * end_d < end_n * start_d)
+        return;
 
-    if (start < end)
+    /* a scan lights the same squares each time it is started */
+    if (fov_scan_repeated(row, start_n, start_d, end_n, end_d))
         return;
 
-    int radius_squared = radius * radius;
+    const int radius_squared = radius * radius;
 
     for (int j = row; j <= radius + 1; j++)
     {
-        int dx = -j - 1;
-        int dy = -j;
-
-        int blocked = false;
+        bool blocked = false;
 
-        while (dx <= 0)
+        /* scan the row from dx = -j to dx = 0 */
+        for (int k = j; k >= 0; k--)
         {
-            dx += 1;
-
             /* Translate the dx, dy coordinates into map coordinates: */
-            int X = X(center) + dx * xx + dy * xy;
-            int Y = Y(center) + dx * yx + dy * yy;
+            const int x = X(center) - k * xx - j * xy;
+            const int y = Y(center) - k * yx - j * yy;
 
             /* check if coordinated are within bounds */
-            if ((X < 0) || (X >= MAP_MAX_X))
+            if ((x < 0) || (x >= MAP_MAX_X))
                 continue;
 
-            if ((Y < 0) || (Y >= MAP_MAX_Y))
+            if ((y < 0) || (y >= MAP_MAX_Y))
                 continue;
 
-            /* l_slope and r_slope store the slopes of the left and right
-             * extremities of the square we're considering: */
-            float l_slope = ((float)dx - 0.5f) / ((float)dy + 0.5f);
-            float r_slope = ((float)dx + 0.5f) / ((float)dy - 0.5f);
+            /* the slopes of the left and right extremities of the
+               square we're considering: (k + 1/2) / (j -+ 1/2) */
+            const int l_n = 2 * k + 1, l_d = 2 * j - 1;
+            const int r_n = 2 * k - 1, r_d = 2 * j + 1;
 
-            if (start < r_slope)
+            if (start_n * r_d < r_n * start_d)
             {
                 continue;
             }
-            else if (end > l_slope)
+            else if (end_n * l_d > l_n * end_d)
             {
                 break;
             }
-            else
-            {
-                position pos = { { X, Y, m->nlevel } };
 
-                /* Our light beam is touching this square; light it */
-                if ((dx * dx + dy * dy) < radius_squared)
-                {
-                    fov_set(fv, pos, true, infravision, true);
-                }
+            /* Our light beam is touching this square; light it */
+            if ((k * k + j * j) < radius_squared)
+                fov_bit_set(fv, x, y);
 
-                if (blocked)
+            const bool opaque = !map_transparent_at(m, x, y);
+
+            if (blocked)
+            {
+                /* we're scanning a row of blocked squares */
+                if (opaque)
                 {
-                    /* we're scanning a row of blocked squares */
-                    if (!map_pos_transparent(m, pos))
-                    {
-                        new_start = r_slope;
-                        continue;
-                    }
-                    else
-                    {
-                        blocked = false;
-                        start = new_start;
-                    }
+                    new_start_n = r_n;
+                    new_start_d = r_d;
+                    continue;
                 }
                 else
                 {
-                    if (!map_pos_transparent(m, pos) && (j < radius))
-                    {
-                        /* This is a blocking square, start a child scan */
-                        blocked = true;
-                    }
+                    blocked = false;
+                    start_n = new_start_n;
+                    start_d = new_start_d;
+                }
+            }
+            else
+            {
+                if (opaque && (j < radius))
+                {
+                    /* This is a blocking square, start a child scan */
+                    blocked = true;
+                }
 
-                    fov_calculate_octant(fv, m, center, infravision,
-                                         j + 1, start, l_slope,
-                                         radius, xx, xy, yx, yy);
+                fov_calculate_octant(fv, m, center, j + 1,
+                                     start_n, start_d, l_n, l_d,
+                                     radius, xx, xy, yx, yy);
 
-                    new_start = r_slope;
-                }
+                new_start_n = r_n;
+                new_start_d = r_d;
             }
         }
 
@@ -272,19 +399,170 @@ static void fov_calculate_octant(fov *fv, map *m, position center,
     }
 }
 
-static gint fov_visible_monster_sort(gconstpointer a, gconstpointer b, gpointer center)
+/* Determine if a scan has been done in the current octant already and
+   record it otherwise. Every square that is not blocked starts a child
+   scan, and the scans started from neighbouring squares and rows cover
+   the same rows and slopes time and again. */
+static bool fov_scan_repeated(int row, int start_n, int start_d,
+                              int end_n, int end_d)
 {
-    monster *ma = (monster *) a;
-    monster *mb = (monster *) b;
+    /* the numerators are at least -1; the parts of the slopes fit into
+       12 bits unless the radius exceeds 2000 */
+    g_assert(start_d < 4096 && end_d < 4096);
+
+    const guint64 key = (guint64)row
+                        | (guint64)(start_n + 1) << 16
+                        | (guint64)start_d << 28
+                        | (guint64)(end_n + 1) << 40
+                        | (guint64)end_d << 52;
 
-    int da = pos_distance(*(position *)center, monster_pos(ma));
-    int db = pos_distance(*(position *)center, monster_pos(mb));
+    guint slot = (guint)((key * G_GUINT64_CONSTANT(0x9E3779B97F4A7C15)) >> 52)
+                 % FOV_SCAN_SLOTS;
+
+    while (fov_scans.stamp[slot] == fov_scans.current)
+    {
+        if (fov_scans.key[slot] == key)
+            return true;
+
+        slot = (slot + 1) % FOV_SCAN_SLOTS;
+    }
 
-    if (da < db)
-        return -1;
+    /* keep the table sparse; further scans are simply repeated */
+    if (fov_scans.count >= FOV_SCAN_SLOTS / 2)
+        return false;
 
-    if (da > db)
-        return 1;
+    fov_scans.key[slot] = key;
+    fov_scans.stamp[slot] = fov_scans.current;
+    fov_scans.count++;
+
+    return false;
+}
+
+/* floor of n / d for positive d */
+static inline int fov_div_floor(int n, int d)
+{
+    return (n >= 0) ? n / d : -((d - 1 - n) / d);
+}
+
+/* The slopes are given as fractions of integers with positive
+   denominators. The left edge of a field has the slope
+   (2 * col - 1) / (2 * depth). */
+static void fov_calculate_quadrant(fov *fv, map *m, position center,
+                                   int depth, int start_n, int start_d,
+                                   int end_n, int end_d, int radius,
+                                   int cx, int rx, int cy, int ry)
+{
+    if (depth > radius)
+        return;
+
+    /* the columns covered by the beam, rounding ties towards the
+       center of the row */
+    const int min_col = fov_div_floor(2 * depth * start_n + start_d,
+                                      2 * start_d);
+    const int max_col = -fov_div_floor(end_d - 2 * depth * end_n,
+                                       2 * end_d);
+
+    /* the previous field: -1 for none, 0 for transparent, 1 for opaque */
+    int prev = -1;
+
+    for (int col = min_col; col <= max_col; col++)
+    {
+        const int x = X(center) + col * cx + depth * rx;
+        const int y = Y(center) + col * cy + depth * ry;
+
+        /* fields outside of the map are treated as opaque */
+        const bool inside = (x >= 0) && (x < MAP_MAX_X)
+                            && (y >= 0) && (y < MAP_MAX_Y);
+        const bool opaque = !inside || !map_transparent_at(m, x, y);
+
+        /* opaque fields are lit when touched by the beam */
+        if (inside && (opaque || ((col * start_d >= depth * start_n)
+                                  && (col * end_d <= depth * end_n))))
+        {
+            fov_bit_set(fv, x, y);
+        }
+
+        if (prev == 1 && !opaque)
+        {
+            /* the beam starts again after a run of opaque fields */
+            start_n = 2 * col - 1;
+            start_d = 2 * depth;
+        }
+        else if (prev == 0 && opaque)
+        {
+            /* scan the next row up to the blocking field */
+            fov_calculate_quadrant(fv, m, center, depth + 1,
+                                   start_n, start_d, 2 * col - 1, 2 * depth,
+                                   radius, cx, rx, cy, ry);
+        }
+
+        prev = opaque;
+    }
+
+    /* continue unless the row ended with an opaque field */
+    if (prev == 0)
+    {
+        fov_calculate_quadrant(fv, m, center, depth + 1,
+                               start_n, start_d, end_n, end_d,
+                               radius, cx, rx, cy, ry);
+    }
+}
+
+/* add the monsters standing on lit tiles to the list of visible monsters;
+   only the tiles within radius of the center can be lit */
+static void fov_collect_monsters(fov *fv, map *m, int radius,
+                                 bool infravision)
+{
+    const int y_min = max(0, Y(fv->center) - radius);
+    const int y_max = min(MAP_MAX_Y - 1, Y(fv->center) + radius);
+    const int x_min = max(0, X(fv->center) - radius);
+    const int x_max = min(MAP_MAX_X - 1, X(fv->center) + radius);
+
+    for (int y = y_min; y <= y_max; y++)
+    {
+        for (int word = x_min / MAP_WORD_BITS;
+                word <= x_max / MAP_WORD_BITS; word++)
+        {
+            guint64 bits = fv->data[y][word];
+
+            for (int x = word * MAP_WORD_BITS; bits != 0; x++, bits >>= 1)
+            {
+                position pos = { { x, y, m->nlevel } };
+                monster *mon;
+
+                /* Must not be an unknown mimic or invisible. */
+                if ((bits & 1)
+                        && (mon = map_get_monster_at(m, pos))
+                        && !monster_unknown(mon)
+                        && (!monster_flags(mon, INVISIBLE) || infravision))
+                {
+                    /* every field is visited once */
+                    fov_monster_add(fv, mon, false);
+                }
+            }
+        }
+    }
+}
+
+/* insert a monster into the list of visible monsters behind those which
+   are closer or at the same distance; the list is short */
+static void fov_monster_add(fov *fv, monster *mon, bool check_duplicate)
+{
+    fov_monster fm = { mon, pos_distance(fv->center, monster_pos(mon)) };
+    guint idx = fv->mlist->len;
+
+    if (check_duplicate)
+    {
+        for (guint i = 0; i < fv->mlist->len; i++)
+            if (g_array_index(fv->mlist, fov_monster, i).m == mon)
+                return;
+    }
+
+    while (idx > 0 && g_array_index(fv->mlist, fov_monster, idx - 1).distance
+                      > fm.distance)
+    {
+        idx--;
+    }
 
-    return 0;
+    g_array_insert_val(fv->mlist, idx, fm);
 }
@@ -48,6 +48,7 @@
 #include "display.h"
 #include "game.h"
 #include "extdefs.h"
+#include "pathfinding.h"
 #include "player.h"
 #include "spheres.h"
 #include "random.h"
@@ -56,6 +57,7 @@ const guint MOBUL = 100;
 const guint TIMELIMIT = 30000;
 
 static void game_new();
+static map *game_map_generate(int nlevel);
 static bool game_load();
 static void game_items_shuffle(game *g);
 
@@ -177,16 +179,20 @@ game *game_destroy(game *g)
 {
     g_assert(g != NULL);
 
+    if (g->maps[0] == NULL || g->p == NULL || g->log == NULL)
+    {
+        /* killed early during game initialisation; the town, the player
+           and the diary exist in every game that has been set up */
+        g_free(g);
+        return NULL;
+    }
+
     /* everything must go */
     for (int i = 0; i < MAP_MAX; i++)
     {
-        if (g->maps[i] == NULL)
-        {
-            /* killed early during game initialisation */
-            g_free(g);
-            return NULL;
-        }
-        map_destroy(g->maps[i]);
+        /* levels the player has not entered have not been generated */
+        if (g->maps[i] != NULL)
+            map_destroy(g->maps[i]);
     }
 
     player_destroy(g->p);
@@ -205,6 +211,10 @@ game *game_destroy(game *g)
 
     g_ptr_array_foreach(g->spheres, (GFunc)sphere_destroy, g);
     g_ptr_array_free(g->spheres, true);
+
+    /* the distance fields refer to the maps destroyed above */
+    path_fields_clear();
+
     g_free(g);
 
     return NULL;
@@ -234,7 +244,8 @@ int game_save(game *g)
     cJSON_AddItemToObject(save, "maps", obj = cJSON_CreateArray());
     for (int idx = 0; idx < MAP_MAX; idx++)
     {
-        cJSON_AddItemToArray(obj, map_serialize(g->maps[idx]));
+        cJSON_AddItemToArray(obj, g->maps[idx] ? map_serialize(g->maps[idx])
+                                               : cJSON_CreateNull());
     }
 
     cJSON_AddItemToObject(save, "amulet_created",
@@ -375,6 +386,10 @@ map *game_map(game *g, guint nmap)
 {
     g_assert (g != NULL && nmap < MAP_MAX);
 
+    /* levels are generated when they are entered for the first time */
+    if (g->maps[nmap] == NULL)
+        g->maps[nmap] = game_map_generate(nmap);
+
     return g->maps[nmap];
 }
 
@@ -390,7 +405,9 @@ void game_spin_the_wheel(game *g)
     /* per-map actions */
     for (int nmap = 0; nmap < MAP_MAX; nmap++)
     {
-        amap = game_map(g, nmap);
+        /* nothing happens on levels that have not been generated yet */
+        if ((amap = g->maps[nmap]) == NULL)
+            continue;
 
         /* call map timers */
         map_timer(amap);
@@ -553,17 +570,9 @@ static void game_new()
     /* initialize the monastery */
     building_monastery_init();
 
-    /* generate levels */
-    for (size_t idx = 0; idx < MAP_MAX; idx++)
-    {
-        /* if map_new fails, it returns NULL.
-           loop while no map has been generated */
-        do
-        {
-            nlarn->maps[idx] = map_new(idx, nlarn_mazefile);
-        }
-        while (nlarn->maps[idx] == NULL);
-    }
+    /* generate the town; the other levels are generated by game_map()
+       when they are entered for the first time */
+    nlarn->maps[0] = game_map_generate(0);
 
     /* game time handling */
     nlarn->gtime = 1;
@@ -578,6 +587,21 @@ static void game_new()
     log_set_time(nlarn->log, nlarn->gtime);
 }
 
+static map *game_map_generate(int nlevel)
+{
+    map *m;
+
+    /* if map_new fails, it returns NULL.
+       loop while no map has been generated */
+    do
+    {
+        m = map_new(nlevel, nlarn_mazefile);
+    }
+    while (m == NULL);
+
+    return m;
+}
+
 static bool game_load()
 {
     display_window *win = NULL;
@@ -759,7 +783,13 @@ static bool game_load()
     size = cJSON_GetArraySize(obj);
     g_assert(size == MAP_MAX);
     for (int idx = 0; idx < size; idx++)
-        nlarn->maps[idx] = map_deserialize(cJSON_GetArrayItem(obj, idx));
+    {
+        cJSON *mser = cJSON_GetArrayItem(obj, idx);
+
+        /* levels which have not been entered are stored as null */
+        if (!cJSON_IsNull(mser))
+            nlarn->maps[idx] = map_deserialize(mser);
+    }
 
 
     /* restore dnd store stock */
@@ -25,6 +25,9 @@
 #include "extdefs.h"
 #include "potions.h"
 
+/* the number of changes made to any inventory */
+static guint32 inv_change_count = 0;
+
 /* functions */
 
 inventory *inv_new(gconstpointer owner)
@@ -41,6 +44,8 @@ void inv_destroy(inventory *inv, bool special)
 {
     g_return_if_fail(inv != NULL);
 
+    inv_change_count++;
+
     while (inv_length(inv) > 0)
     {
         item *it = inv_get(inv, inv_length(inv) - 1);
@@ -157,6 +162,8 @@ bool inv_add(inventory **inv, item *it)
         g_ptr_array_add((*inv)->content, it->oid);
     }
 
+    inv_change_count++;
+
     /* call post_add callback */
     if ((*inv)->post_add)
     {
@@ -193,6 +200,7 @@ item *inv_del(inventory **inv, guint idx)
     }
 
     g_ptr_array_remove_index((*inv)->content, idx);
+    inv_change_count++;
 
     if ((*inv)->post_del)
     {
@@ -224,6 +232,7 @@ bool inv_del_element(inventory **inv, item *it)
     }
 
     g_ptr_array_remove((*inv)->content, it->oid);
+    inv_change_count++;
 
     if ((*inv)->post_del)
     {
@@ -251,6 +260,8 @@ bool inv_del_oid(inventory **inv, gpointer oid)
         return false;
     }
 
+    inv_change_count++;
+
     /* destroy inventory if empty and not owned by anybody */
     if (!inv_length(*inv) && !(*inv)->owner)
     {
@@ -281,6 +292,11 @@ void inv_erode(inventory **inv, item_erosion_type iet,
     }
 }
 
+guint32 inv_changes()
+{
+    return inv_change_count;
+}
+
 guint inv_length(inventory *inv)
 {
     return (inv == NULL) ? 0 : inv->content->len;
@@ -37,13 +37,26 @@ static void map_fill_with_objects(map *m);
 static void map_fill_with_traps(map *m);
 
 static void map_tile_from_char(map *m, position pos, int* num_specials, char c);
-static bool map_load_from_file(map *m, const char *mazefile, guint which);
+static bool map_load_from_file(map *m, const char *mazefile, int which);
 static void map_make_maze(map *m, int treasure_room);
 static void map_make_maze_eat(map *m, int x, int y);
+static void map_make_maze_carve(map *m);
 static void map_make_river(map *m, map_tile_t rivertype);
 static void map_make_lake(map *m, map_tile_t laketype);
 static void map_make_treasure_room(map *m, rectangle **rooms);
 static int map_validate(map *m);
+static position map_entrance(map *m);
+static bool map_connect(map *m);
+static bool map_tile_passable_by(map_tile_t type, sobject_t sobject,
+                                 map_element_t element);
+static bool map_tile_candidate(map_tile_t type, sobject_t sobject,
+                               map_element_t element);
+static int map_bits_count(guint64 bits);
+static position map_find_space_sample(map *m, rectangle where,
+                                      map_element_t element, bool dead_end,
+                                      const fov *hidden);
+static void map_tiles_changed(map *m);
+static void map_tile_timer(map *m, position pos);
 
 static inline void map_sphere_destroy(sphere *s, map *m __attribute__((unused)))
 {
@@ -67,9 +80,40 @@ const map_tile_data map_tiles[LT_MAX] =
     { LT_WALL,      '#', GRANITE,         N_("a wall"),      0, 0 },
 };
 
+/* number of random positions map_find_space_in() tries before
+   it searches all candidates */
+#define MAP_SPACE_ATTEMPTS 16
+
+/* a cell of the maze carved by map_make_maze_eat() */
+typedef struct maze_cell
+{
+    guint8 x, y;
+    guint8 dir;   /* next direction to try */
+    guint8 tries; /* remaining rounds through all directions */
+} maze_cell;
+
+/* number of cells of the maze grid (corridors are carved in steps of two) */
+#define MAP_MAZE_CELLS ((MAP_MAX_X / 2 + 1) * (MAP_MAX_Y / 2 + 1))
+
+/* statistics of the level generation */
+static map_generation_stats map_stats = { 0 };
+
+/* connect unreachable parts of mazes instead of carving new ones */
+static bool map_repair_mazes = true;
+
+/* the last generation any map has been stamped with */
+static guint32 map_generations = 0;
+
 /* keep track which levels have been used before */
 static int map_used[MAP_MAZE_NUM + 1] = { 1, 0 };
 
+/* the characters the maze file may contain */
+static const char map_maze_chars[] = " #^\".&~=_+OIHDTLSBM!mo";
+
+/* the predefined levels, as read from the maze file */
+static char map_mazes[MAP_MAZE_NUM][MAP_MAX_Y][MAP_MAX_X];
+static bool map_mazes_loaded = false;
+
 const char *map_names[MAP_MAX] =
 {
     "Town",
@@ -111,6 +155,7 @@ static bool is_volcano_map(int nlevel)
 map *map_new(int num, const char *mazefile)
 {
     bool map_loaded = false;
+    const gint64 start = g_get_monotonic_time();
 
     map *nmap = nlarn->maps[num] = g_malloc0(sizeof(map));
     nmap->nlevel = num;
@@ -131,6 +176,7 @@ map *map_new(int num, const char *mazefile)
             {
                 /* adding stationary objects failed; generate a new map */
                 map_destroy(nmap);
+                map_stats.restarts++;
                 return NULL;
             }
         }
@@ -150,6 +196,15 @@ map *map_new(int num, const char *mazefile)
 
             /* check if entire map is reachable */
             keep_maze = map_validate(nmap);
+
+            if (!keep_maze)
+            {
+                map_stats.rejections++;
+
+                /* connect the unreachable parts instead of starting over */
+                keep_maze = map_repair_mazes
+                            && map_connect(nmap) && map_validate(nmap);
+            }
         }
         while (!keep_maze);
     }
@@ -166,9 +221,50 @@ map *map_new(int num, const char *mazefile)
     /* add inhabitants to the map */
     map_fill_with_life(nmap);
 
+    const gint64 duration = g_get_monotonic_time() - start;
+
+    map_stats.levels++;
+    map_stats.time += duration;
+    map_stats.time_max = max(map_stats.time_max, duration);
+
     return nmap;
 }
 
+void map_generation_set_repair(bool repair)
+{
+    map_repair_mazes = repair;
+}
+
+const map_generation_stats *map_generation_stats_get()
+{
+    return &map_stats;
+}
+
+char *map_generation_stats_describe()
+{
+    const guint32 levels = max(map_stats.levels, 1);
+    const guint32 mazes = max(map_stats.mazes, 1);
+    const guint32 validations = max(map_stats.validations, 1);
+
+    return g_strdup_printf("Levels generated     : %u\n"
+                           "Mazes carved         : %u\n"
+                           "Levels restarted     : %u\n"
+                           "Mazes restarted      : %u\n"
+                           "Unreachable mazes    : %u\n"
+                           "Tunnels carved       : %u\n"
+                           "Avg. carve time      : %" G_GINT64_FORMAT " us\n"
+                           "Avg. validation time : %" G_GINT64_FORMAT " us\n"
+                           "Avg. generation time : %" G_GINT64_FORMAT " us\n"
+                           "Max. generation time : %" G_GINT64_FORMAT " us\n",
+                           map_stats.levels, map_stats.mazes,
+                           map_stats.restarts, map_stats.maze_restarts,
+                           map_stats.rejections, map_stats.tunnels,
+                           map_stats.carve_time / mazes,
+                           map_stats.validate_time / validations,
+                           map_stats.time / levels,
+                           map_stats.time_max);
+}
+
 cJSON *map_serialize(map *m)
 {
     cJSON *grid, *tile;
@@ -187,55 +283,55 @@ cJSON *map_serialize(map *m)
             cJSON_AddItemToArray(grid, tile = cJSON_CreateObject());
 
             cJSON_AddStringToObject(tile, "type",
-                    map_tile_t_string(m->grid[y][x].type));
+                    map_tile_t_string(m->type[y][x]));
 
-            if (m->grid[y][x].base_type > 0
-                    && m->grid[y][x].base_type != m->grid[y][x].type)
+            if (m->base_type[y][x] > 0
+                    && m->base_type[y][x] != m->type[y][x])
             {
                 cJSON_AddStringToObject(tile, "base_type",
-                        map_tile_t_string(m->grid[y][x].base_type));
+                        map_tile_t_string(m->base_type[y][x]));
             }
 
-            if (m->grid[y][x].timer)
+            if (m->timer[y][x])
             {
                 cJSON_AddNumberToObject(tile, "timer",
-                                        m->grid[y][x].timer);
+                                        m->timer[y][x]);
             }
 
-            if (m->grid[y][x].sobject)
+            if (m->sobject[y][x])
             {
                 cJSON_AddStringToObject(tile, "sobject",
-                        sobject_t_string(m->grid[y][x].sobject));
+                        sobject_t_string(m->sobject[y][x]));
             }
 
-            if (m->grid[y][x].trap)
+            if (m->trap[y][x])
             {
                 cJSON_AddStringToObject(tile, "trap",
-                        trap_t_string(m->grid[y][x].trap));
+                        trap_t_string(m->trap[y][x]));
             }
 
-            if (m->grid[y][x].spill)
+            if (m->spill[y][x])
             {
                 cJSON_AddStringToObject(tile, "spill",
-                        colour_t_string(m->grid[y][x].spill));
+                        colour_t_string(m->spill[y][x]));
             }
 
-            if (m->grid[y][x].spilltime)
+            if (m->spilltime[y][x])
             {
                 cJSON_AddNumberToObject(tile, "spilltime",
-                                        m->grid[y][x].spilltime);
+                                        m->spilltime[y][x]);
             }
 
-            if (m->grid[y][x].m_oid)
+            if (m->m_oid[y][x])
             {
                 cJSON_AddNumberToObject(tile, "monster",
-                                        GPOINTER_TO_UINT(m->grid[y][x].m_oid));
+                                        GPOINTER_TO_UINT(m->m_oid[y][x]));
             }
 
-            if (m->grid[y][x].ilist )
+            if (m->ilist[y][x] )
             {
                 cJSON_AddItemToObject(tile, "inventory",
-                                      inv_serialize(m->grid[y][x].ilist));
+                                      inv_serialize(m->ilist[y][x]));
             }
         }
     }
@@ -258,42 +354,90 @@ map *map_deserialize(cJSON *mser)
         {
             cJSON *tile = cJSON_GetArrayItem(grid, x + (y * MAP_MAX_X));
 
-            m->grid[y][x].type =
+            m->type[y][x] =
                 map_tile_t_value(cJSON_GetObjectItem(tile, "type")->valuestring);
 
             cJSON *obj = cJSON_GetObjectItem(tile, "base_type");
-            if (obj != NULL) m->grid[y][x].base_type =
+            if (obj != NULL) m->base_type[y][x] =
                 map_tile_t_value(obj->valuestring);
 
             obj = cJSON_GetObjectItem(tile, "timer");
-            if (obj != NULL) m->grid[y][x].timer = obj->valueint;
+            if (obj != NULL) m->timer[y][x] = obj->valueint;
 
             obj = cJSON_GetObjectItem(tile, "sobject");
-            if (obj != NULL) m->grid[y][x].sobject =
+            if (obj != NULL) m->sobject[y][x] =
                 sobject_t_value(obj->valuestring);
 
             obj = cJSON_GetObjectItem(tile, "trap");
-            if (obj != NULL) m->grid[y][x].trap =
+            if (obj != NULL) m->trap[y][x] =
                 trap_t_value(obj->valuestring);
 
             obj = cJSON_GetObjectItem(tile, "spill");
-            if (obj != NULL) m->grid[y][x].spill =
+            if (obj != NULL) m->spill[y][x] =
                 colour_t_value(obj->valuestring);
 
             obj = cJSON_GetObjectItem(tile, "spilltime");
-            if (obj != NULL) m->grid[y][x].spilltime = obj->valueint;
+            if (obj != NULL) m->spilltime[y][x] = obj->valueint;
 
             obj = cJSON_GetObjectItem(tile, "monster");
-            if (obj != NULL) m->grid[y][x].m_oid = GUINT_TO_POINTER(obj->valueint);
+            if (obj != NULL) m->m_oid[y][x] = GUINT_TO_POINTER(obj->valueint);
 
             obj = cJSON_GetObjectItem(tile, "inventory");
-            if (obj != NULL) m->grid[y][x].ilist = inv_deserialize(obj);
+            if (obj != NULL) m->ilist[y][x] = inv_deserialize(obj);
+
+            if (m->timer[y][x] || m->spill[y][x])
+            {
+                position pos = pos_invalid;
+                X(pos) = x;
+                Y(pos) = y;
+                Z(pos) = m->nlevel;
+                map_tile_activate(m, pos);
+            }
         }
     }
 
+    map_tiles_changed(m);
+
     return m;
 }
 
+void map_tile_changed(map *m, position pos)
+{
+    g_assert(m != NULL && pos_valid(pos));
+
+    const map_tile_t type = m->type[Y(pos)][X(pos)];
+    const sobject_t sobject = m->sobject[Y(pos)][X(pos)];
+    const int word = X(pos) / MAP_WORD_BITS;
+    const guint64 bit = (guint64)1 << (X(pos) % MAP_WORD_BITS);
+
+    if (mt_is_transparent(type) && so_is_transparent(sobject))
+        m->transparent[Y(pos)][word] |= bit;
+    else
+        m->transparent[Y(pos)][word] &= ~bit;
+
+    for (map_element_t element = LE_GROUND; element < LE_MAX; element++)
+    {
+        guint64 *pword = &m->passable[element][Y(pos)][word];
+        const guint64 prev = *pword;
+
+        if (map_tile_passable_by(type, sobject, element))
+            *pword |= bit;
+        else
+            *pword &= ~bit;
+
+        /* the connected areas have to be determined again */
+        if (*pword != prev)
+            m->components_valid &= ~(1 << element);
+
+        if (map_tile_candidate(type, sobject, element))
+            m->candidates[element][Y(pos)][word] |= bit;
+        else
+            m->candidates[element][Y(pos)][word] &= ~bit;
+    }
+
+    m->generation = ++map_generations;
+}
+
 char *map_dump(map *m, position ppos)
 {
     position pos = pos_invalid;
@@ -345,8 +489,8 @@ void map_destroy(map *m)
     for (int y = 0; y < MAP_MAX_Y; y++)
         for (int x = 0; x < MAP_MAX_X; x++)
         {
-            if (m->grid[y][x].m_oid != NULL) {
-                monster *mon = game_monster_get(nlarn, m->grid[y][x].m_oid);
+            if (m->m_oid[y][x] != NULL) {
+                monster *mon = game_monster_get(nlarn, m->m_oid[y][x]);
 
                 /* I wonder why it is possible that a monster ID is stored at
                  * a position while there is no matching monster registered.
@@ -354,8 +498,8 @@ void map_destroy(map *m)
                 if (mon != NULL) monster_destroy(mon);
             }
 
-            if (m->grid[y][x].ilist != NULL)
-                inv_destroy(m->grid[y][x].ilist, true);
+            if (m->ilist[y][x] != NULL)
+                inv_destroy(m->ilist[y][x], true);
         }
 
     g_free(m);
@@ -373,41 +517,7 @@ position map_find_space_in(map *m,
                            map_element_t element,
                            bool dead_end)
 {
-    position pos = pos_invalid;
-    int iteration = 0;
-
-    g_assert (m != NULL && element < LE_MAX);
-
-    X(pos) = rand_m_n(where.x1, where.x2);
-    Y(pos) = rand_m_n(where.y1, where.y2);
-    Z(pos) = m->nlevel;
-
-    /* number of positions inside the rectangle */
-    int count = (where.x2 - where.x1 + 1) * (where.y2 - where.y1 + 1);
-
-    do
-    {
-        X(pos)++;
-
-        if (X(pos) > where.x2)
-        {
-            X(pos) = where.x1;
-            Y(pos)++;
-        }
-
-        if (Y(pos) > where.y2)
-        {
-            Y(pos) = where.y1;
-        }
-
-        iteration++;
-    }
-    while (!map_pos_validate(m, pos, element, dead_end) && (iteration <= count));
-
-    if (iteration > count )
-        pos = pos_invalid;
-
-    return pos;
+    return map_find_space_sample(m, where, element, dead_end, NULL);
 }
 
 int *map_get_surrounding(map *m, position pos, sobject_t type)
@@ -460,8 +570,9 @@ bool map_pos_validate(map *m, position pos, map_element_t element,
     if (Z(pos) != m->nlevel)
         return false;
 
-    /* make shortcut */
-    map_tile *tile = map_tile_at(m, pos);
+    /* make shortcuts */
+    const map_tile_t type = map_tiletype_at(m, pos);
+    const sobject_t sobject = map_sobject_at(m, pos);
 
     /* check for a dead end */
     if (dead_end)
@@ -484,11 +595,11 @@ bool map_pos_validate(map *m, position pos, map_element_t element,
     switch (element)
     {
     case LE_GROUND:
-        return mt_is_passable(tile->type);
+        return mt_is_passable(type);
         break;
 
     case LE_SOBJECT:
-        if (mt_is_passable(tile->type) && (tile->sobject == LS_NONE))
+        if (mt_is_passable(type) && (sobject == LS_NONE))
         {
             /* find free space */
             position p = pos;
@@ -505,15 +616,15 @@ bool map_pos_validate(map *m, position pos, map_element_t element,
         break;
 
     case LE_TRAP:
-        return (mt_is_passable(tile->type)
-                && (tile->sobject == LS_NONE)
-                && (tile->trap == TT_NONE));
+        return (mt_is_passable(type)
+                && (sobject == LS_NONE)
+                && (map_trap_at(m, pos) == TT_NONE));
         break;
 
     case LE_ITEM:
         /* we can stack like mad, so we only need to check if
          * there is an open space */
-        return (map_pos_passable(m, pos) && (tile->sobject == LS_NONE));
+        return (map_pos_passable(m, pos) && (sobject == LS_NONE));
         break;
 
     case LE_MONSTER:
@@ -539,151 +650,118 @@ bool map_pos_validate(map *m, position pos, map_element_t element,
     return false;
 }
 
-int map_pos_is_visible(map *m, position s, position t)
-{
-    /* positions on different levels? */
-    if (Z(s) != Z(t))
-        return false;
-
-    int x = X(s);
-    int y = Y(s);
+/* Bresenham's line algorithm depends only on the distances along the
+   major and minor axis of a ray and on the direction along the major axis,
+   which decides ties. Bit i of map_ray_minor[dir][major][minor] is set if
+   step i + 1 of such a ray advances along the minor axis. The table takes
+   about 36 KiB. */
+static guint64 map_ray_minor[2][MAP_MAX_X][MAP_MAX_Y][MAP_ROW_WORDS];
+static bool map_ray_minor_ready = false;
 
-    int delta_x = abs(X(t) - X(s)) << 1;
-    int delta_y = abs(Y(t) - Y(s)) << 1;
-
-    /* if x1 == x2 or y1 == y2, then it does not matter what we set here */
-    signed int ix = X(t) > X(s) ? 1 : -1;
-    signed int iy = Y(t) > Y(s) ? 1 : -1;
-
-    if (delta_x >= delta_y)
+static void map_ray_tables_init()
+{
+    for (int dir = 0; dir < 2; dir++)
     {
-        /* error may go below zero */
-        int error = delta_y - (delta_x >> 1);
-
-        while (x != X(t))
+        for (int major = 0; major < MAP_MAX_X; major++)
         {
-            if (error >= 0)
+            for (int minor = 0; minor <= min(major, MAP_MAX_Y - 1); minor++)
             {
-                if (error || (ix > 0))
-                {
-                    y += iy;
-                    error -= delta_x;
-                }
-            }
-
-            x += ix;
-            error += delta_y;
+                guint64 *bits = map_ray_minor[dir][major][minor];
 
-            if (!mt_is_transparent(m->grid[y][x].type)
-                    || !so_is_transparent(m->grid[y][x].sobject))
-            {
-                return false;
-            }
-        }
-    }
-    else
-    {
-        /* error may go below zero */
-        int error = delta_x - (delta_y >> 1);
+                /* error may go below zero */
+                int error = 2 * minor - major;
 
-        while (y != Y(t))
-        {
-            if (error >= 0)
-            {
-                if (error || (iy > 0))
+                for (int step = 0; step < major; step++)
                 {
-                    x += ix;
-                    error -= delta_y;
-                }
-            }
-
-            y += iy;
-            error += delta_x;
+                    if (error >= 0 && (error || dir))
+                    {
+                        bits[step / MAP_WORD_BITS] |=
+                            (guint64)1 << (step % MAP_WORD_BITS);
+                        error -= 2 * major;
+                    }
 
-            if (!mt_is_transparent(m->grid[y][x].type)
-                    || !so_is_transparent(m->grid[y][x].sobject))
-            {
-                return false;
+                    error += 2 * minor;
+                }
             }
         }
     }
 
-    return true;
+    map_ray_minor_ready = true;
 }
 
-GList *map_ray(map *m, position source, position target)
+guint map_ray_fill(map *m, position source, position target, position *ray)
 {
-    GList *ray = NULL;
-    position pos = source;
+    g_assert(m != NULL && ray != NULL);
 
-    /* Insert the source position */
-    ray = g_list_append(ray, GUINT_TO_POINTER(source.val));
+    if (!map_ray_minor_ready)
+        map_ray_tables_init();
 
-    int delta_x = abs(X(target) - X(source)) << 1;
-    int delta_y = abs(Y(target) - Y(source)) << 1;
+    const int dx = X(target) - X(source);
+    const int dy = Y(target) - Y(source);
+    const bool x_major = (abs(dx) >= abs(dy));
+    const int major = x_major ? abs(dx) : abs(dy);
+    const int minor = x_major ? abs(dy) : abs(dx);
 
     /* if x1 == x2 or y1 == y2, then it does not matter what we set here */
-    int inc_x = X(target) > X(source) ? 1 : -1;
-    int inc_y = Y(target) > Y(source) ? 1 : -1;
+    const int inc_x = dx > 0 ? 1 : -1;
+    const int inc_y = dy > 0 ? 1 : -1;
+
+    const guint64 *bits = map_ray_minor[(x_major ? inc_x : inc_y) > 0]
+                                       [major][minor];
+    position pos = source;
+    guint len = 0;
 
-    if (delta_x >= delta_y)
+    /* insert the source position */
+    ray[len++] = source;
+
+    for (int step = 0; step < major; step++)
     {
-        /* error may go below zero */
-        int error = delta_y - (delta_x >> 1);
+        const bool sidestep = (bits[step / MAP_WORD_BITS]
+                               >> (step % MAP_WORD_BITS)) & 1;
 
-        while (X(pos) != X(target))
+        if (x_major)
         {
-            if (error >= 0)
-            {
-                if (error || (inc_x > 0))
-                {
-                    Y(pos) += inc_y;
-                    error -= delta_x;
-                }
-            }
-
             X(pos) += inc_x;
-            error += delta_y;
+            if (sidestep) Y(pos) += inc_y;
+        }
+        else
+        {
+            Y(pos) += inc_y;
+            if (sidestep) X(pos) += inc_x;
+        }
 
-            /* append even the last position to the list */
-            ray = g_list_append(ray, GUINT_TO_POINTER(pos.val));
+        /* add even the last position */
+        ray[len++] = pos;
 
-            if (!map_pos_transparent(m, pos))
-                break; /* stop following ray */
-        }
+        if (!map_transparent_at(m, X(pos), Y(pos)))
+            break; /* stop following ray */
     }
-    else
-    {
-        /* error may go below zero */
-        int error = delta_x - (delta_y >> 1);
 
-        while (Y(pos) != Y(target))
-        {
-            if (error >= 0)
-            {
-                if (error || (inc_y > 0))
-                {
-                    X(pos) += inc_x;
-                    error -= delta_y;
-                }
-            }
+    return pos_identical(pos, target) ? len : 0;
+}
 
-            Y(pos) += inc_y;
-            error += delta_x;
+int map_pos_is_visible(map *m, position s, position t)
+{
+    position ray[MAP_RAY_MAX];
 
-            /* append even the last position to the list */
-            ray = g_list_append(ray, GUINT_TO_POINTER(pos.val));
+    /* positions on different levels? */
+    if (Z(s) != Z(t))
+        return false;
 
-            if (!map_pos_transparent(m, pos))
-                break; /* stop following ray */
-        }
-    }
+    const guint len = map_ray_fill(m, s, t, ray);
 
-    if (ray && GPOINTER_TO_UINT(g_list_last(ray)->data) != target.val)
-    {
-        g_list_free(ray);
-        ray = NULL;
-    }
+    /* the target itself has to be transparent, too */
+    return (len == 1) || (len > 1 && map_transparent_at(m, X(t), Y(t)));
+}
+
+GList *map_ray(map *m, position source, position target)
+{
+    position steps[MAP_RAY_MAX];
+    GList *ray = NULL;
+
+    /* prepend from the end to keep the order */
+    for (guint len = map_ray_fill(m, source, target, steps); len > 0; len--)
+        ray = g_list_prepend(ray, GUINT_TO_POINTER(steps[len - 1].val));
 
     return ray;
 }
@@ -699,26 +777,25 @@ bool map_trajectory(position source, position target,
     map *tmap = game_map(nlarn, Z(source));
 
     /* get the ray */
-    GList *ray = map_ray(tmap, source, target);
-    GList *iter = ray;
+    position ray[MAP_RAY_MAX];
+    const guint len = map_ray_fill(tmap, source, target, ray);
 
     /* it was impossible to get a ray for the given positions */
-    if (!ray)
+    if (len == 0)
         return false;
 
     /* follow the ray to determine if it hits something */
-    do
+    for (guint step = 0; step < len; step++)
     {
         bool result = false;
-        position cursor;
-        pos_val(cursor) = GPOINTER_TO_UINT(iter->data);
+        position cursor = ray[step];
 
         /* skip the source position */
         if (pos_identical(source, cursor))
             continue;
 
         /* the position is affected, call the callback function */
-        if (pos_hitfun(iter, damo, data1, data2))
+        if (pos_hitfun(ray, step, damo, data1, data2))
         {
             /* the callback returned that the ray if finished */
             result = true;
@@ -729,7 +806,6 @@ bool map_trajectory(position source, position target,
                 || (pos_identical(cursor, nlarn->p->pos)
                             && player_effect(nlarn->p, ET_REFLECTION))))
         {
-            g_list_free(ray);
             /* repaint the screen before showing the reflection, otherwise
              * the reflection wouldn't be visible! */
             display_paint_screen(nlarn->p);
@@ -741,19 +817,14 @@ bool map_trajectory(position source, position target,
         /* after checking for reflection, abort the function if the
            callback indicated success */
         if (result == true)
-        {
-            g_list_free(ray);
             return result;
-        }
 
         /* show the position of the ray only when visible to the player */
         if (fov_get(nlarn->p->fv, cursor))
             display_animate_glyph(cursor, glyph, fg, keep_ray);
     }
-    while ((iter = iter->next));
 
     /* none of the trigger functions succeeded */
-    g_list_free(ray);
     return false;
 }
 
@@ -825,18 +896,17 @@ void map_set_tiletype(map *m, area *ar, map_tile_t type, guint8 duration)
             /* if the position is marked in area set the tile to type */
             if (area_point_get(ar, x, y))
             {
-                map_tile *tile = map_tile_at(m, pos);
-
                 /* store original type if it has not been set already
                    (this can occur when casting multiple flood
                    spells on the same tile) */
-                if (tile->base_type == LT_NONE)
-                    tile->base_type = map_tiletype_at(m, pos);
+                if (map_basetype_at(m, pos) == LT_NONE)
+                    map_basetype_set(m, pos, map_tiletype_at(m, pos));
+
+                map_tiletype_set(m, pos, type);
 
-                tile->type = type;
                 /* if non-permanent, let the radius shrink with time */
                 if (duration != 0)
-                    tile->timer = max(1, duration - 5 * pos_distance(pos, center));
+                    map_timer_set(m, pos, max(1, duration - 5 * pos_distance(pos, center)));
             }
         }
     }
@@ -976,7 +1046,7 @@ monster *map_get_monster_at(map *m, position pos)
 {
     g_assert(m != NULL && m->nlevel == Z(pos) && pos_valid(pos));
 
-    gpointer mid = m->grid[Y(pos)][X(pos)].m_oid;
+    gpointer mid = m->m_oid[Y(pos)][X(pos)];
     return (mid != NULL) ? game_monster_get(nlarn, mid) : NULL;
 }
 
@@ -1018,20 +1088,19 @@ void map_fill_with_life(map *m)
     /* create monsters until the desired count is reached */
     while (m->mcount <= new_monster_count)
     {
-        position pos = pos_invalid;
+        rectangle entire_map = rect_new(1, 1, MAP_MAX_X - 2, MAP_MAX_Y - 2);
 
-        do
-        {
-            pos = map_find_space(m, LE_MONSTER, false);
+        /* do not let monsters appear in front of the player */
+        const bool player_here = (Z(nlarn->p->pos) == m->nlevel);
+        position pos = map_find_space_sample(m, entire_map, LE_MONSTER, false,
+                                             player_here ? nlarn->p->fv : NULL);
 
-            if (!pos_valid(pos))
-            {
-                /* it seems that the map is fully crowded,
-                   thus abort monster creation. */
-                return;
-            }
+        if (!pos_valid(pos))
+        {
+            /* it seems that the map is fully crowded,
+               thus abort monster creation. */
+            return;
         }
-        while (fov_get(nlarn->p->fv, pos));
 
         monster_new_by_level(pos);
     }
@@ -1061,74 +1130,28 @@ bool map_is_exit_at(map *m, position pos)
 void map_timer(map *m)
 {
     position pos = pos_invalid;
-    item_erosion_type erosion;
 
     g_assert (m != NULL);
 
+    /* nothing burns or has been spilled on this map */
+    if (m->active_count == 0)
+        return;
+
     Z(pos) = m->nlevel;
 
     for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
     {
-        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        for (int word = 0; word < MAP_ROW_WORDS; word++)
         {
-            if (map_timer_at(m, pos))
-            {
-                map_tile *tile = map_tile_at(m, pos);
-                tile->timer--;
-
-                /* affect items every three turns */
-                if ((tile->ilist != NULL) && (tile->timer % 5 == 0))
-                {
-                    switch (tile->type)
-                    {
-                    case LT_CLOUD:
-                        erosion = IET_CORRODE;
-                        break;
-
-                    case LT_FIRE:
-                        erosion = IET_BURN;
-                        break;
-
-                    case LT_WATER:
-                        erosion = IET_RUST;
-                        break;
-                    default:
-                        erosion = IET_NONE;
-                        break;
-                    }
-
-                    inv_erode(&tile->ilist, erosion,
-                            fov_get(nlarn->p->fv, pos), NULL);
-                }
+            guint64 bits = m->active[Y(pos)][word];
 
-                /* reset tile type if temporary effect has expired */
-                if (tile->timer == 0)
-                {
-                    if ((tile->type == LT_FIRE)
-                            && (tile->base_type == LT_GRASS))
-                    {
-                        tile->base_type = LT_NONE;
-                        tile->type = LT_DIRT;
-                    }
-                    else
-                    {
-                        tile->type = tile->base_type;
-                    }
-                }
-            } /* if map_timer_at */
-
-            if (map_spill_at(m, pos))
+            for (X(pos) = word * MAP_WORD_BITS; bits != 0; X(pos)++, bits >>= 1)
             {
-                map_tile *tile = map_tile_at(m, pos);
-
-                tile->spilltime--;
-                if (tile->spilltime < 1)
-                {
-                    tile->spill = 0;
-                }
-            } /* map_spill_at */
-        } /* for X(pos) */
-    } /* for Y(pos) */
+                if (bits & 1)
+                    map_tile_timer(m, pos);
+            }
+        }
+    }
 }
 
 wchar_t map_get_door_glyph(map *m, position pos)
@@ -1463,6 +1486,8 @@ static void map_make_maze(map *m, int treasure_room)
     Z(pos) = m->nlevel;
 
 generate:
+    map_stats.mazes++;
+
     /* reset map by filling it with walls */
     for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
         for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
@@ -1477,10 +1502,11 @@ generate:
                 monster_destroy(mon);
             }
 
-            if (map_tile_at(m, pos)->ilist != NULL)
+            inventory **ilist = map_ilist_at(m, pos);
+            if (*ilist != NULL)
             {
-                inv_destroy(map_tile_at(m, pos)->ilist, true);
-                map_tile_at(m, pos)->ilist = NULL;
+                inv_destroy(*ilist, true);
+                *ilist = NULL;
             }
         }
 
@@ -1495,19 +1521,22 @@ generate:
         else
             map_make_lake(m, rivertype);
 
-        if (m->grid[1][1].type == LT_WALL)
-            map_make_maze_eat(m, 1, 1);
+        if (m->type[1][1] == LT_WALL)
+            map_make_maze_carve(m);
     }
     else
-        map_make_maze_eat(m, 1, 1);
+        map_make_maze_carve(m);
 
     /* add exit to town on map 1 */
     if (m->nlevel == 1)
     {
-        m->grid[MAP_MAX_Y - 1][(MAP_MAX_X - 1) / 2].type = LT_FLOOR;
-        m->grid[MAP_MAX_Y - 1][(MAP_MAX_X - 1) / 2].sobject = LS_CAVERNS_EXIT;
+        m->type[MAP_MAX_Y - 1][(MAP_MAX_X - 1) / 2] = LT_FLOOR;
+        m->sobject[MAP_MAX_Y - 1][(MAP_MAX_X - 1) / 2] = LS_CAVERNS_EXIT;
     }
 
+    /* the maze has been dug into the grid directly */
+    map_tiles_changed(m);
+
     /* generate open spaces */
     int nrooms = rand_1n(3) + 3;
     if (treasure_room)
@@ -1543,11 +1572,10 @@ generate:
         {
             for (X(pos) = rooms[room]->x1 ; X(pos) < rooms[room]->x2 ; X(pos)++)
             {
-                map_tile *tile = map_tile_at(m, pos);
-                if (tile->type == rivertype)
+                if (map_tiletype_at(m, pos) == rivertype)
                     continue;
 
-                tile->type = LT_FLOOR;
+                map_tiletype_set(m, pos, LT_FLOOR);
 
                 if (want_monster == true)
                 {
@@ -1565,6 +1593,12 @@ generate:
     if (!map_fill_with_stationary_objects(m))
     {
         /* adding stationary objects failed; generate a new map */
+        for (int room = 0; room < nrooms; room++)
+            g_free(rooms[room]);
+
+        g_free(rooms);
+        map_stats.maze_restarts++;
+
         goto generate;
     }
 
@@ -1579,62 +1613,97 @@ generate:
     g_free(rooms);
 }
 
+/* carve the corridors of a maze, starting at the upper left corner */
+static void map_make_maze_carve(map *m)
+{
+    const gint64 start = g_get_monotonic_time();
+
+    map_make_maze_eat(m, 1, 1);
+
+    map_stats.carve_time += g_get_monotonic_time() - start;
+}
+
 /* function to eat away a filled in maze */
 static void map_make_maze_eat(map *m, int x, int y)
 {
-    int try = 2;
+    /* The corridors are carved in steps of two tiles, thus every cell of
+       the grid can be entered only once; the stack never holds more
+       frames than the grid has cells. */
+    maze_cell stack[MAP_MAZE_CELLS];
+    int top = 0;
 
-    int dir = rand_1n(4);
+    stack[top++] = (maze_cell){ x, y, rand_1n(4), 2 };
 
-    while (try)
+    while (top > 0)
     {
-        switch (dir)
+        maze_cell *cell = &stack[top - 1];
+
+        if (cell->tries == 0)
+        {
+            /* all directions have been tried twice */
+            top--;
+            continue;
+        }
+
+        int nx = cell->x;
+        int ny = cell->y;
+
+        switch (cell->dir)
         {
         case 1: /* west */
-            if ((x > 2) &&
-                    (m->grid[y][x - 1].type == LT_WALL) &&
-                    (m->grid[y][x - 2].type == LT_WALL))
+            if ((nx > 2) &&
+                    (m->type[ny][nx - 1] == LT_WALL) &&
+                    (m->type[ny][nx - 2] == LT_WALL))
             {
-                m->grid[y][x - 1].type = m->grid[y][x - 2].type = LT_FLOOR;
-                map_make_maze_eat(m, x - 2, y);
+                m->type[ny][nx - 1] = m->type[ny][nx - 2] = LT_FLOOR;
+                nx -= 2;
             }
             break;
 
         case 2: /* east */
-            if (x < (MAP_MAX_X - 3) &&
-                    (m->grid[y][x + 1].type == LT_WALL) &&
-                    (m->grid[y][x + 2].type == LT_WALL))
+            if (nx < (MAP_MAX_X - 3) &&
+                    (m->type[ny][nx + 1] == LT_WALL) &&
+                    (m->type[ny][nx + 2] == LT_WALL))
             {
-                m->grid[y][x + 1].type = m->grid[y][x + 2].type = LT_FLOOR;
-                map_make_maze_eat(m, x + 2, y);
+                m->type[ny][nx + 1] = m->type[ny][nx + 2] = LT_FLOOR;
+                nx += 2;
             }
             break;
 
         case 3: /* south */
-            if ((y > 2) &&
-                    (m->grid[y - 1][x].type == LT_WALL) &&
-                    (m->grid[y - 2][x].type == LT_WALL))
+            if ((ny > 2) &&
+                    (m->type[ny - 1][nx] == LT_WALL) &&
+                    (m->type[ny - 2][nx] == LT_WALL))
             {
-                m->grid[y - 1][x].type = m->grid[y - 2][x].type = LT_FLOOR;
-                map_make_maze_eat(m, x, y - 2);
+                m->type[ny - 1][nx] = m->type[ny - 2][nx] = LT_FLOOR;
+                ny -= 2;
             }
             break;
 
         case 4: /* north */
-            if ((y < MAP_MAX_Y - 3) &&
-                    (m->grid[y + 1][x].type == LT_WALL) &&
-                    (m->grid[y + 2][x].type == LT_WALL))
+            if ((ny < MAP_MAX_Y - 3) &&
+                    (m->type[ny + 1][nx] == LT_WALL) &&
+                    (m->type[ny + 2][nx] == LT_WALL))
             {
-                m->grid[y + 1][x].type = m->grid[y + 2][x].type = LT_FLOOR;
-                map_make_maze_eat(m, x, y + 2);
+                m->type[ny + 1][nx] = m->type[ny + 2][nx] = LT_FLOOR;
+                ny += 2;
             }
 
             break;
         };
-        if (++dir > 4)
+
+        /* advance to the next direction before descending, the way the
+           recursive version continued after returning */
+        if (++cell->dir > 4)
         {
-            dir = 1;
-            try--;
+            cell->dir = 1;
+            cell->tries--;
+        }
+
+        if (nx != cell->x || ny != cell->y)
+        {
+            g_assert(top < MAP_MAZE_CELLS);
+            stack[top++] = (maze_cell){ nx, ny, rand_1n(4), 2 };
         }
     }
 }
@@ -1753,12 +1822,12 @@ static void map_make_lake(map *m, map_tile_t laketype)
 
 static void place_special_item(map *m, position npos)
 {
-    map_tile *tile = map_tile_at(m, npos);
+    inventory **ilist = map_ilist_at(m, npos);
 
     switch (m->nlevel)
     {
     case MAP_CMAX - 1: /* the amulet of larn */
-        inv_add(&tile->ilist, item_new(IT_AMULET, AM_LARN));
+        inv_add(ilist, item_new(IT_AMULET, AM_LARN));
 
         monster_new(
                 MT_DEMONLORD_I + rand_0n(min(game_difficulty(nlarn), 7)),
@@ -1766,7 +1835,7 @@ static void place_special_item(map *m, position npos)
         break;
 
     case MAP_MAX - 1: /* potion of cure dianthroritis */
-        inv_add(&tile->ilist, item_new(IT_POTION, PO_CURE_DIANTHR));
+        inv_add(ilist, item_new(IT_POTION, PO_CURE_DIANTHR));
         monster_new(MT_DEMON_PRINCE, npos, NULL);
 
     default:
@@ -1777,84 +1846,86 @@ static void place_special_item(map *m, position npos)
 
 static void map_tile_from_char(map *m, position pos, int* num_specials, char c)
 {
-    map_tile *tile = map_tile_at(m, pos);
+    guint8 *type = &m->type[Y(pos)][X(pos)];
+    guint8 *sobject = &m->sobject[Y(pos)][X(pos)];
 
-    /* floor is the default */
-    tile->type = LT_FLOOR;
+    /* floor is the default; monsters placed below check it */
+    *type = LT_FLOOR;
+    map_tile_changed(m, pos);
 
     switch (c)
     {
 
     case '^': /* mountain */
-        tile->type = LT_MOUNTAIN;
+        *type = LT_MOUNTAIN;
         break;
 
     case '"': /* grass */
-        tile->type = LT_GRASS;
+        *type = LT_GRASS;
         break;
 
     case '.': /* dirt */
-        tile->type = LT_DIRT;
+        *type = LT_DIRT;
         break;
 
     case '&': /* tree */
-        tile->type = LT_TREE;
+        *type = LT_TREE;
         break;
 
     case '~': /* deep water */
-        tile->type = LT_DEEPWATER;
+        *type = LT_DEEPWATER;
         break;
 
     case '=': /* lava */
-        tile->type = LT_LAVA;
+        *type = LT_LAVA;
         break;
 
     case '#': /* wall */
-        tile->type =  LT_WALL;
+        *type = LT_WALL;
         break;
 
     case '_': /* altar */
-        tile->sobject = LS_ALTAR;
+        *sobject = LS_ALTAR;
         break;
 
     case '+': /* door */
-        tile->sobject = LS_CLOSEDDOOR;
+        *sobject = LS_CLOSEDDOOR;
         break;
 
     case 'O': /* caverns entrance */
-        tile->sobject = LS_CAVERNS_ENTRY;
+        *sobject = LS_CAVERNS_ENTRY;
         break;
 
     case 'I': /* elevator */
-        tile->sobject = LS_ELEVATORDOWN;
+        *sobject = LS_ELEVATORDOWN;
         break;
 
     case 'H': /* home */
-        tile->sobject = LS_HOME;
+        *sobject = LS_HOME;
         break;
 
     case 'D': /* dnd store */
-        tile->sobject = LS_DNDSTORE;
+        *sobject = LS_DNDSTORE;
         break;
 
     case 'T': /* trade post */
-        tile->sobject = LS_TRADEPOST;
+        *sobject = LS_TRADEPOST;
         break;
 
     case 'L': /* LRS */
-        tile->sobject = LS_LRS;
+        *sobject = LS_LRS;
         break;
 
     case 'S': /* school */
-        tile->sobject = LS_SCHOOL;
+        *sobject = LS_SCHOOL;
         break;
 
     case 'B': /* bank */
-        tile->sobject = LS_BANK;
+        *sobject = LS_BANK;
         break;
 
     case 'M': /* monastery */
-        tile->sobject = LS_MONASTERY;
+        *sobject = LS_MONASTERY;
         break;
 
     case '!': /* potion of cure dianthroritis, eye of larn */
@@ -1873,14 +1944,81 @@ static void map_tile_from_char(map *m, position pos, int* num_specials, char c)
                 it = rand_1n(IT_MAX - 1);
             } while (it == IT_CONTAINER);
 
-            inv_add(&tile->ilist, item_new_by_level(it, m->nlevel));
+            inv_add(map_ilist_at(m, pos), item_new_by_level(it, m->nlevel));
         }
         break;
     };
+
+    map_tile_changed(m, pos);
+}
+
+char *map_mazes_load(const char *mazefile)
+{
+    gchar *content = NULL;
+
+    g_assert(mazefile != NULL);
+
+    /* slurp maze file */
+    if (!g_file_get_contents(mazefile, &content, NULL, NULL))
+    {
+        return g_strdup_printf("Could not read the maze file %s.", mazefile);
+    }
+
+    /* Split content by line */
+    gchar **lines = g_strsplit(content, "\n", -1);
+    g_free(content);
+
+    guint num_lines = g_strv_length(lines);
+    char *error = NULL;
+
+    for (int map_num = 0; map_num < MAP_MAZE_NUM && !error; map_num++)
+    {
+        /* every map consists of MAP_MAX_Y lines + 1 blank line */
+        guint start_line = map_num * (MAP_MAX_Y + 1);
+
+        if (start_line + MAP_MAX_Y > num_lines)
+        {
+            error = g_strdup_printf("The maze file %s contains %d of %d mazes.",
+                                    mazefile, map_num, MAP_MAZE_NUM);
+            break;
+        }
+
+        for (int y = 0; y < MAP_MAX_Y && !error; y++)
+        {
+            const gchar *line = lines[start_line + y];
+
+            /* validate line width */
+            if (strlen(line) < MAP_MAX_X)
+            {
+                error = g_strdup_printf("Line %d of the maze file %s is too short.",
+                                        start_line + y + 1, mazefile);
+                break;
+            }
+
+            /* validate the characters */
+            const size_t x = strspn(line, map_maze_chars);
+
+            if (x < MAP_MAX_X)
+            {
+                error = g_strdup_printf("Line %d of the maze file %s "
+                                        "contains the unknown character '%c'.",
+                                        start_line + y + 1, mazefile, line[x]);
+                break;
+            }
+
+            memcpy(map_mazes[map_num][y], line, MAP_MAX_X);
+        }
+    }
+
+    g_strfreev(lines);
+
+    map_mazes_loaded = (error == NULL);
+
+    return error;
 }
 
 /*
- *  function to read in a maze from a data file
+ *  function to create a level from the predefined mazes
  *
  *  Format of maze data file:
  *  For each maze:  MAP_MAX_Y + 1 lines (MAP_MAX_Y used)
@@ -1894,20 +2032,25 @@ static void map_tile_from_char(map *m, position pos, int* num_specials, char c)
  *      !   potion of cure dianthroritis, or the amulet of larn, as appropriate
  *      o   random object
  */
-static bool map_load_from_file(map *m, const char *mazefile, guint which)
+static bool map_load_from_file(map *m, const char *mazefile, int which)
 {
     position pos;       /* current position on map */
     int map_num = 0;    /* number of selected map */
-    gchar *content = NULL;
 
-    /* slurp maze file */
-    if (!g_file_get_contents(mazefile, &content, NULL, NULL))
+    /* the maze file is usually loaded at startup */
+    if (!map_mazes_loaded)
     {
-        return false;
+        char *error = map_mazes_load(mazefile);
+
+        if (error != NULL)
+        {
+            g_free(error);
+            return false;
+        }
     }
 
     /* roll the dice: which map? */
-    if (which <= MAP_MAX_MAZE_NUM)
+    if (which >= 0 && which <= MAP_MAX_MAZE_NUM)
     {
         map_num = which;
     }
@@ -1923,21 +2066,6 @@ static bool map_load_from_file(map *m, const char *mazefile, guint which)
         map_used[map_num] = true;
     }
 
-    /* Split content by line */
-    gchar **lines = g_strsplit(content, "\n", -1);
-    g_free(content);
-
-    guint num_lines = g_strv_length(lines);
-    /* every map consists of MAP_MAX_Y lines + 1 blank line */
-    guint start_line = map_num * (MAP_MAX_Y + 1);
-
-    /* validate file */
-    if (start_line + MAP_MAX_Y > num_lines)
-    {
-        g_strfreev(lines);
-        return false;
-    }
-
     // Sometimes flip the maps. (Never the town)
     bool flip_vertical   = (map_num > 0 && chance(50));
     bool flip_horizontal = (map_num > 0 && chance(50));
@@ -1948,17 +2076,6 @@ static bool map_load_from_file(map *m, const char *mazefile, guint which)
     Z(pos) = m->nlevel;
     for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
     {
-        gchar *line = lines[start_line + Y(pos)];
-
-        /* validate line width */
-        if (strlen(line) < MAP_MAX_X)
-        {
-            g_strfreev(lines);
-            nlarn = game_destroy(nlarn);
-            display_show_message(_("Error"), _("Maze file is corrupted. Please reinstall the game."), 0);
-            exit(EXIT_FAILURE);
-        }
-
         for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
         {
             position map_pos = pos;
@@ -1967,12 +2084,11 @@ static bool map_load_from_file(map *m, const char *mazefile, guint which)
             if (flip_horizontal)
                 Y(map_pos) = MAP_MAX_Y - Y(pos) - 1;
 
-            map_tile_from_char(m, map_pos, &spec_count, line[X(pos)]);
+            map_tile_from_char(m, map_pos, &spec_count,
+                               map_mazes[map_num][Y(pos)][X(pos)]);
         }
     }
 
-    g_strfreev(lines);
-
     /* if the amulet of larn/pcd has not been placed yet, place it randomly */
     if (spec_count >= 0)
         place_special_item(m, map_find_space(m, LE_ITEM, false));
@@ -2071,6 +2187,7 @@ static void map_make_treasure_room(map *m, rectangle **rooms)
 /* verify that every space on the map can be reached */
 static int map_validate(map *m)
 {
+    const gint64 start = g_get_monotonic_time();
     position pos = pos_invalid;
     int connected = true;
     area *floodmap = NULL;
@@ -2088,22 +2205,7 @@ static int map_validate(map *m)
             }
 
     /* get position of entrance */
-    switch (m->nlevel)
-    {
-        /* caverns entrance */
-    case 1:
-        pos = map_find_sobject(m, LS_CAVERNS_EXIT);
-        break;
-
-        /* volcano entrance */
-    case MAP_CMAX:
-        pos = map_find_sobject(m, LS_ELEVATORUP);
-        break;
-
-    default:
-        pos = map_find_sobject(m, LS_STAIRSDOWN);
-        break;
-    }
+    pos = map_entrance(m);
 
     /* flood fill the maze starting at the entrance */
     floodmap = area_flood(obsmap, X(pos), Y(pos));
@@ -2130,12 +2232,446 @@ static int map_validate(map *m)
 
     area_destroy(floodmap);
 
+    map_stats.validations++;
+    map_stats.validate_time += g_get_monotonic_time() - start;
+
     return connected;
 }
 
+static position map_entrance(map *m)
+{
+    switch (m->nlevel)
+    {
+        /* caverns entrance */
+    case 1:
+        return map_find_sobject(m, LS_CAVERNS_EXIT);
+
+        /* volcano entrance */
+    case MAP_CMAX:
+        return map_find_sobject(m, LS_ELEVATORUP);
+
+    default:
+        return map_find_sobject(m, LS_STAIRSDOWN);
+    }
+}
+
+/* the tiles map_connect() distinguishes */
+enum map_connect_state
+{
+    MC_SOLID,       /* wall, can be tunneled through */
+    MC_OPEN,        /* passable, not connected to the entrance yet */
+    MC_CONNECTED,   /* passable and connected to the entrance */
+    MC_FIXED,       /* impassable and must be kept, e.g. rivers */
+};
+
+/*
+ * Connect all parts of a map which can not be reached from the entrance.
+ * For every unreachable part, the tunnel requiring the fewest tiles to be
+ * dug out is carved to the reachable part of the map. Only walls are dug;
+ * parts cut off by water or lava fail, and the maze is carved again.
+ */
+static bool map_connect(map *m)
+{
+    const int dx[] = { -1, 1, 0, 0 };
+    const int dy[] = { 0, 0, -1, 1 };
+
+    guint8 state[MAP_SIZE];
+    guint16 dist[MAP_SIZE];
+    guint16 parent[MAP_SIZE];
+    /* double-ended queue for the 0-1 breadth-first search; a tile is
+       queued at most twice, at either end */
+    guint16 queue[4 * MAP_SIZE];
+
+    position pos = pos_invalid;
+    Z(pos) = m->nlevel;
+
+    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+    {
+        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        {
+            const int idx = Y(pos) * MAP_MAX_X + X(pos);
+
+            if (map_pos_passable(m, pos)
+                    || map_sobject_at(m, pos) == LS_CLOSEDDOOR)
+                state[idx] = MC_OPEN;
+            else if (X(pos) == 0 || X(pos) == MAP_MAX_X - 1
+                     || Y(pos) == 0 || Y(pos) == MAP_MAX_Y - 1
+                     || map_tiletype_at(m, pos) != LT_WALL
+                     || map_sobject_at(m, pos) != LS_NONE)
+                state[idx] = MC_FIXED;
+            else
+                state[idx] = MC_SOLID;
+        }
+    }
+
+    pos = map_entrance(m);
+    if (!pos_valid(pos))
+        return false;
+
+    int start = Y(pos) * MAP_MAX_X + X(pos);
+
+    while (start >= 0)
+    {
+        /* mark the part of the map containing start as connected */
+        int head = 0, tail = 0;
+
+        queue[tail++] = start;
+        state[start] = MC_CONNECTED;
+
+        while (head < tail)
+        {
+            const int idx = queue[head++];
+
+            for (int dir = 0; dir < 4; dir++)
+            {
+                const int x = idx % MAP_MAX_X + dx[dir];
+                const int y = idx / MAP_MAX_X + dy[dir];
+
+                if (x < 0 || x >= MAP_MAX_X || y < 0 || y >= MAP_MAX_Y)
+                    continue;
+
+                const int nidx = y * MAP_MAX_X + x;
+
+                if (state[nidx] == MC_OPEN)
+                {
+                    state[nidx] = MC_CONNECTED;
+                    queue[tail++] = nidx;
+                }
+            }
+        }
+
+        /* find the next unreachable part */
+        int region = -1;
+        for (int idx = 0; idx < MAP_SIZE && region < 0; idx++)
+            if (state[idx] == MC_OPEN)
+                region = idx;
+
+        if (region < 0)
+            break;
+
+        /* search the cheapest tunnel from the unreachable part to the
+           connected part. Solid tiles cost one, passable tiles nothing. */
+        for (int idx = 0; idx < MAP_SIZE; idx++)
+            dist[idx] = G_MAXUINT16;
+
+        head = tail = 2 * MAP_SIZE;
+        queue[tail++] = region;
+        dist[region] = 0;
+        parent[region] = region;
+
+        int goal = -1;
+        while (head < tail)
+        {
+            const int idx = queue[head++];
+
+            if (state[idx] == MC_CONNECTED)
+            {
+                goal = idx;
+                break;
+            }
+
+            for (int dir = 0; dir < 4; dir++)
+            {
+                const int x = idx % MAP_MAX_X + dx[dir];
+                const int y = idx / MAP_MAX_X + dy[dir];
+
+                if (x < 0 || x >= MAP_MAX_X || y < 0 || y >= MAP_MAX_Y)
+                    continue;
+
+                const int nidx = y * MAP_MAX_X + x;
+
+                if (state[nidx] == MC_FIXED)
+                    continue;
+
+                const int cost = (state[nidx] == MC_SOLID) ? 1 : 0;
+
+                if (dist[idx] + cost < dist[nidx])
+                {
+                    dist[nidx] = dist[idx] + cost;
+                    parent[nidx] = idx;
+
+                    if (cost == 0)
+                        queue[--head] = nidx;
+                    else
+                        queue[tail++] = nidx;
+                }
+            }
+        }
+
+        if (goal < 0)
+        {
+            /* the part is walled in by stationary objects */
+            return false;
+        }
+
+        /* dig out the tunnel */
+        for (int idx = goal; idx != region; idx = parent[idx])
+        {
+            if (state[idx] == MC_SOLID)
+            {
+                X(pos) = idx % MAP_MAX_X;
+                Y(pos) = idx / MAP_MAX_X;
+                map_tiletype_set(m, pos, LT_FLOOR);
+
+                state[idx] = MC_OPEN;
+            }
+        }
+
+        map_stats.tunnels++;
+
+        /* the part is connected now */
+        start = region;
+    }
+
+    return true;
+}
+
 /* subroutine to put an item onto an empty space */
 void map_item_add(map *m, item *what)
 {
     position pos = map_find_space(m, LE_ITEM, false);
     inv_add(map_ilist_at(m, pos), what);
 }
+
+/* the rules monster_valid_dest() applies to the tile itself */
+static bool map_tile_passable_by(map_tile_t type, sobject_t sobject,
+                                 map_element_t element)
+{
+    switch (type)
+    {
+    case LT_WALL:
+        return (element == LE_XORN);
+
+    case LT_DEEPWATER:
+        if (element == LE_SWIMMING_MONSTER)
+            return true;
+        // else fall through
+    case LT_LAVA:
+        return (element == LE_FLYING_MONSTER);
+
+    default:
+        /* the map tile must be passable */
+        return mt_is_passable(type) && so_is_passable(sobject);
+    }
+}
+
+/* update the bitplanes of the entire map */
+static void map_tiles_changed(map *m)
+{
+    position pos = pos_invalid;
+    Z(pos) = m->nlevel;
+
+    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+            map_tile_changed(m, pos);
+}
+
+/* process the timer and the spill of an active tile */
+static void map_tile_timer(map *m, position pos)
+{
+    const int x = X(pos), y = Y(pos);
+    item_erosion_type erosion;
+
+    if (m->timer[y][x])
+    {
+        m->timer[y][x]--;
+
+        /* affect items every three turns */
+        if ((m->ilist[y][x] != NULL) && (m->timer[y][x] % 5 == 0))
+        {
+            switch (m->type[y][x])
+            {
+            case LT_CLOUD:
+                erosion = IET_CORRODE;
+                break;
+
+            case LT_FIRE:
+                erosion = IET_BURN;
+                break;
+
+            case LT_WATER:
+                erosion = IET_RUST;
+                break;
+            default:
+                erosion = IET_NONE;
+                break;
+            }
+
+            inv_erode(&m->ilist[y][x], erosion,
+                    fov_get(nlarn->p->fv, pos), NULL);
+        }
+
+        /* reset tile type if temporary effect has expired */
+        if (m->timer[y][x] == 0)
+        {
+            if ((m->type[y][x] == LT_FIRE)
+                    && (m->base_type[y][x] == LT_GRASS))
+            {
+                m->base_type[y][x] = LT_NONE;
+                m->type[y][x] = LT_DIRT;
+            }
+            else
+            {
+                m->type[y][x] = m->base_type[y][x];
+            }
+
+            map_tile_changed(m, pos);
+        }
+    }
+
+    if (m->spill[y][x])
+    {
+        m->spilltime[y][x]--;
+        if (m->spilltime[y][x] < 1)
+        {
+            m->spill[y][x] = 0;
+        }
+    }
+
+    /* the tile has returned to normal */
+    if (!m->timer[y][x] && !m->spill[y][x])
+    {
+        m->active[y][x / MAP_WORD_BITS] &= ~((guint64)1 << (x % MAP_WORD_BITS));
+        m->active_count--;
+    }
+}
+
+/* the checks of map_pos_validate() that depend on the tile alone */
+static bool map_tile_candidate(map_tile_t type, sobject_t sobject,
+                               map_element_t element)
+{
+    switch (element)
+    {
+    case LE_GROUND:
+        return mt_is_passable(type);
+
+    case LE_SOBJECT:
+    case LE_TRAP:
+        return mt_is_passable(type) && (sobject == LS_NONE);
+
+    case LE_ITEM:
+        return map_tile_passable_by(type, sobject, LE_MONSTER)
+            && (sobject == LS_NONE);
+
+    default:
+        return map_tile_passable_by(type, sobject, element);
+    }
+}
+
+/* the number of bits set in a bitplane word */
+static int map_bits_count(guint64 bits)
+{
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+
+    return (bits * 0x0101010101010101ULL) >> 56;
+}
+
+/* Pick a random position inside the rectangle that passes
+   map_pos_validate(), each of them with the same probability.
+   Positions set in the hidden field of vision are not returned. */
+static position map_find_space_sample(map *m, rectangle where,
+                                      map_element_t element, bool dead_end,
+                                      const fov *hidden)
+{
+    guint64 rows[MAP_MAX_Y][MAP_ROW_WORDS] = { { 0 } };
+    guint count = 0;
+    position pos = pos_invalid;
+
+    g_assert (m != NULL && element < LE_MAX);
+
+    /* the rectangle may reach beyond the map */
+    const int x2 = min(where.x2, MAP_MAX_X - 1);
+    const int y2 = min(where.y2, MAP_MAX_Y - 1);
+
+    if (where.x1 > x2 || where.y1 > y2)
+        return pos_invalid;
+
+    Z(pos) = m->nlevel;
+
+    /* Usually a good part of the rectangle is free, thus try a few
+       random positions first. Each candidate is as likely to be
+       drawn as any other. */
+    for (int attempt = 0; attempt < MAP_SPACE_ATTEMPTS; attempt++)
+    {
+        X(pos) = rand_m_n(where.x1, x2 + 1);
+        Y(pos) = rand_m_n(where.y1, y2 + 1);
+
+        const guint64 bit = (guint64)1 << (X(pos) % MAP_WORD_BITS);
+        const int word = X(pos) / MAP_WORD_BITS;
+
+        if (!(m->candidates[element][Y(pos)][word] & bit))
+            continue;
+
+        if (hidden && (fov_row(hidden, Y(pos))[word] & bit))
+            continue;
+
+        if (map_pos_validate(m, pos, element, dead_end))
+            return pos;
+    }
+
+    /* collect the candidates inside the rectangle */
+    for (int y = where.y1; y <= y2; y++)
+    {
+        const guint64 *vis = hidden ? fov_row(hidden, y) : NULL;
+
+        for (int word = 0; word < MAP_ROW_WORDS; word++)
+        {
+            /* the columns of the rectangle inside this word */
+            const int lo = max(where.x1 - word * MAP_WORD_BITS, 0);
+            const int hi = min(x2 - word * MAP_WORD_BITS, MAP_WORD_BITS - 1);
+
+            if (hi < lo)
+                continue;
+
+            guint64 bits = m->candidates[element][y][word]
+                           & (~(guint64)0 >> (MAP_WORD_BITS - 1 - hi))
+                           & (~(guint64)0 << lo);
+
+            if (vis != NULL)
+                bits &= ~vis[word];
+
+            rows[y][word] = bits;
+            count += map_bits_count(bits);
+        }
+    }
+
+    /* draw without replacement until a candidate passes the checks
+       which depend on monsters, the player or the neighbourhood; if
+       none is left the rectangle is full */
+    while (count > 0)
+    {
+        guint nth = rand_0n(count);
+        int y = where.y1, word = 0;
+
+        /* find the word holding the drawn candidate */
+        while (nth >= (guint)map_bits_count(rows[y][word]))
+        {
+            nth -= map_bits_count(rows[y][word]);
+
+            if (++word == MAP_ROW_WORDS)
+            {
+                word = 0;
+                y++;
+            }
+        }
+
+        /* and the candidate inside the word */
+        guint64 bits = rows[y][word];
+        int x = word * MAP_WORD_BITS;
+
+        for (; !(bits & 1) || nth-- > 0; x++, bits >>= 1);
+
+        X(pos) = x;
+        Y(pos) = y;
+
+        if (map_pos_validate(m, pos, element, dead_end))
+            return pos;
+
+        rows[y][word] &= ~((guint64)1 << (x % MAP_WORD_BITS));
+        count--;
+    }
+
+    return pos_invalid;
+}
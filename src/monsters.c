@@ -778,13 +778,15 @@ static position monster_move_serve(monster *m, struct player *p);
 static position monster_move_civilian(monster *m, struct player *p);
 
 static void monster_fov_ensure(monster *m);
-static monster *monster_nearest_hostile_to(monster *m, position anchor);
-static position monster_engage_or_approach(monster *m, monster *target);
+static monster *monster_nearest_hostile_to(monster *m, position anchor,
+        position *step);
+static position monster_engage_or_approach(monster *m, monster *target,
+        position step);
 
-static bool monster_breath_hit(const GList *traj,
+static bool monster_breath_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
-static bool monster_shoot_hit(const GList *traj,
+static bool monster_shoot_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
 
@@ -818,13 +820,7 @@ monster *monster_new(monster_t type, position pos, gpointer leader)
     /* determine max hp; prevent the living dead */
     nmonster->hp_max = nmonster->hp = max(1, divert(monster_type_hp_max(type), 10));
 
-    /* Some differentiation of the visible range per monster type */
-    nmonster->visrange = max(3,
-        5
-        // slower monsters see less, faster more
-        + ((monster_data[type].speed - NORMAL) / 25)
-        // flying monsters see further
-        + (monster_type_flags(type, FLY) ? 2 : 0));
+    nmonster->visrange = monster_type_visrange(type);
 
     nmonster->effects = g_ptr_array_new();
     nmonster->inv = inv_new(nmonster);
@@ -1210,7 +1206,11 @@ void monster_deserialize(cJSON *mser, game *g)
     else
         // TODO: fallback for older saves, can be removed when updating
         // SAVEFILE_VERSION > 29
-        m->visrange = 5;
+        m->visrange = monster_type_visrange(m->type);
+
+    /* older saves hold the overflowed ranges of slow monsters */
+    if (m->visrange < 3 || m->visrange > MONSTER_VISRANGE_MAX)
+        m->visrange = monster_type_visrange(m->type);
 
     if ((obj = cJSON_GetObjectItem(mser, "leader")))
     {
@@ -1300,22 +1300,8 @@ int monster_valid_dest(map *m, position pos, int map_elem)
     if (map_elem == LE_GROUND && pos_identical(pos, nlarn->p->pos))
         return false;
 
-    switch (map_tiletype_at(m, pos))
-    {
-    case LT_WALL:
-        return (map_elem == LE_XORN);
-
-    case LT_DEEPWATER:
-        if (map_elem == LE_SWIMMING_MONSTER)
-            return true;
-        // else fall through
-    case LT_LAVA:
-        return (map_elem == LE_FLYING_MONSTER);
-
-    default:
-        /* the map tile must be passable */
-        return map_pos_passable(m, pos);
-    }
+    /* the map keeps track of which tiles can be entered by whom */
+    return map_pos_passable_by(m, pos, map_elem);
 }
 
 int monster_pos_set(monster *m, map *mp, position target)
@@ -1354,6 +1340,12 @@ bool monster_unknown(monster *m)
 void monster_unknown_set(monster *m, bool what)
 {
     g_assert (m != NULL);
+
+    /* undiscovered mimics are remembered as items, thus
+       the player's memory of the tile has to be renewed */
+    if (m->unknown != what && pos_valid(m->pos))
+        map_tile_changed(monster_map(m), m->pos);
+
     m->unknown = what;
 }
 
@@ -2377,14 +2369,14 @@ void monster_player_attack(monster *m, player *p)
     }
 }
 
-static bool monster_shoot_hit(const GList *traj,
+static bool monster_shoot_hit(const position *traj, guint step,
                               const damage_originator *damo,
                               gpointer data1,
                               gpointer data2)
 {
     damage *dam = (damage *)data1;
     item *ammo = (item *)data2;
-    position pos; pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
     map *mp = game_map(nlarn, Z(pos));
 
     gchar *adesc = item_describe_gc(ammo,
@@ -2912,10 +2904,25 @@ char *monster_desc(monster *m)
     else
         injury = N_("critically injured");
 
-    /* for fighting civilians, find the hostile target in FOV */
-    monster *fight_target = (m->action == MA_CIVILIAN)
-                            ? monster_nearest_hostile_to(m, m->pos)
-                            : NULL;
+    /* for fighting civilians, find the closest hostile target in FOV */
+    monster *fight_target = NULL;
+
+    if (m->action == MA_CIVILIAN && m->fv != NULL)
+    {
+        monster *hostile;
+        int best_dist = G_MAXINT;
+
+        for (guint vidx = 0; (hostile = fov_visible_monster(m->fv, vidx)); vidx++)
+        {
+            const int dist = pos_distance(monster_pos(hostile), m->pos);
+
+            if (!monster_is_friendly(hostile) && dist < best_dist)
+            {
+                best_dist = dist;
+                fight_target = hostile;
+            }
+        }
+    }
 
     const char *action_desc = (fight_target != NULL) ? N_("fighting")
                                                       : monster_ai_desc[m->action];
@@ -3262,7 +3269,7 @@ static bool monster_player_visible(monster *m)
         return false;
 
     /* determine if player's position is visible from monster's position */
-    return map_pos_is_visible(monster_map(m), m->pos, nlarn->p->pos);
+    return player_seen_from(nlarn->p, m->pos);
 }
 
 static bool monster_attack_available(monster *m, attack_t type)
@@ -3570,23 +3577,12 @@ static position monster_find_next_pos_to(monster *m, position dest)
     g_assert(m != NULL);
     g_assert(pos_valid(dest));
 
-    /* next position */
-    position npos = monster_pos(m);
-
     /* find the next step in the direction of dest */
-    path *path = path_find(monster_map(m), monster_pos(m), dest,
-                           monster_map_element(m));
-
-    if (path && !g_queue_is_empty(path->path))
-    {
-        path_element *el = g_queue_pop_head(path->path);
-        npos = el->pos;
-    }
+    position npos = path_find_step(monster_map(m), monster_pos(m), dest,
+                                   monster_map_element(m));
 
-    /* clean up */
-    if (path) path_destroy(path);
-
-    return npos;
+    /* stay if there is none */
+    return pos_valid(npos) ? npos : monster_pos(m);
 }
 
 static position monster_move_wander(monster *m, struct player *p __attribute__((unused)))
@@ -3649,24 +3645,19 @@ static bool monster_has_clear_shot(monster *m, player *p)
 
     /* check that no monster stands on the line between m and p */
     map *mmap = monster_map(m);
-    GList *ray = map_ray(mmap, monster_pos(m), p->pos);
-    if (!ray)
+    position ray[MAP_RAY_MAX];
+    const guint len = map_ray_fill(mmap, monster_pos(m), p->pos, ray);
+    if (len == 0)
         return false;
 
-    bool clear = true;
     /* skip source (first element) and target (last element) */
-    for (GList *iter = ray->next; iter != NULL && iter->next != NULL; iter = iter->next)
+    for (guint idx = 1; idx + 1 < len; idx++)
     {
-        position pos;
-        pos_val(pos) = GPOINTER_TO_UINT(iter->data);
-        if (map_get_monster_at(mmap, pos) != NULL)
-        {
-            clear = false;
-            break;
-        }
+        if (map_get_monster_at(mmap, ray[idx]) != NULL)
+            return false;
     }
-    g_list_free(ray);
-    return clear;
+
+    return true;
 }
 
 static position monster_move_attack(monster *m, struct player *p)
@@ -3749,10 +3740,14 @@ static position monster_move_attack(monster *m, struct player *p)
             break;
         }
 
-        /* change the map */
-        monster_level_enter(m, game_map(nlarn, newmap));
-
-        return monster_pos(m);
+        /* Change the map. Levels can not be generated while the monsters
+           move, as that would register new monsters in the table being
+           walked; the player has usually entered the map already. */
+        if (nlarn->maps[newmap] != NULL)
+        {
+            monster_level_enter(m, game_map(nlarn, newmap));
+            return monster_pos(m);
+        }
     }
 
     /* when the player is not currently visible, look for friendly monsters
@@ -3764,27 +3759,27 @@ static position monster_move_attack(monster *m, struct player *p)
                       monster_flags(m, INFRAVISION)
                       || monster_effect(m, ET_INFRAVISION));
 
-        GList *visible = fov_get_visible_monsters(m->fv);
-        monster *ftarget = NULL;
-        int best_dist = G_MAXINT;
-        for (GList *iter = visible; iter != NULL; iter = iter->next)
+        /* the visible monsters are ordered by distance */
+        monster *ftarget = NULL, *candidate;
+        for (guint idx = 0; (candidate = fov_visible_monster(m->fv, idx)); idx++)
         {
-            monster *candidate = (monster *)iter->data;
-            if (!monster_is_friendly(candidate)) continue;
-            int dist = pos_distance(monster_pos(m), monster_pos(candidate));
-            if (dist < best_dist)
+            if (monster_is_friendly(candidate))
             {
-                best_dist = dist;
                 ftarget = candidate;
+                break;
             }
         }
-        g_list_free(visible);
         if (ftarget != NULL)
             return monster_find_next_pos_to(m, monster_pos(ftarget));
     }
 
-    /* monster heads into the direction of the player. */
-    npos = monster_find_next_pos_to(m, m->player_pos);
+    /* monster heads into the direction of the player. All monsters aware
+       of the player's current position share the way there. */
+    if (pos_identical(m->player_pos, p->pos))
+        npos = path_field_next_step(mmap, monster_pos(m), p->pos,
+                                    monster_map_element(m));
+    else
+        npos = monster_find_next_pos_to(m, m->player_pos);
 
     /* No path found. Stop following player */
     if (!pos_valid(npos)) m->lastseen = 0;
@@ -3802,10 +3797,23 @@ static position monster_move_confused(monster *m,
 static position monster_move_flee(monster *m, struct player *p)
 {
     int dist = 0;
-    position npos = monster_pos(m);
     map *mmap = monster_map(m);
     bool can_use_doors = monster_flags(m, HANDS) && monster_int(m) > 6;
 
+    /* follow the flee field shared by all monsters fleeing from the player */
+    position npos = path_field_flee_step(mmap, monster_pos(m), p->pos,
+                                         monster_map_element(m));
+
+    /* Monsters not cornered are done. Others look for the farthest field
+       around them, smart ones might escape through a closed door. */
+    if (pos_valid(npos) && (!pos_identical(npos, monster_pos(m))
+                            || !can_use_doors))
+    {
+        return npos;
+    }
+
+    npos = monster_pos(m);
+
     for (int tries = 1; tries < GD_MAX; tries++)
     {
         /* try all fields surrounding the monster if the
@@ -3847,38 +3855,98 @@ static void monster_fov_ensure(monster *m)
 }
 
 /* Return the non-friendly monster visible to m that is closest to anchor,
-   or NULL if none is visible. Requires m->fv to be current. */
-static monster *monster_nearest_hostile_to(monster *m, position anchor)
+   or NULL if none can be reached. If anchor is the monster's position,
+   the hostiles are ranked by path distance, otherwise by their distance
+   to anchor. If step is given, it receives the monster's first step
+   toward the target. Requires m->fv to be current. */
+static monster *monster_nearest_hostile_to(monster *m, position anchor,
+        position *step)
 {
+    if (step) *step = pos_invalid;
     if (m->fv == NULL) return NULL;
 
-    GList *visible = fov_get_visible_monsters(m->fv);
-    monster *target = NULL;
-    int best_dist = G_MAXINT;
-    for (GList *iter = visible; iter != NULL; iter = iter->next)
+    monster *candidate;
+
+    if (!pos_identical(anchor, monster_pos(m)))
     {
-        monster *candidate = (monster *)iter->data;
-        if (monster_is_friendly(candidate)) continue;
-        int dist = pos_distance(monster_pos(candidate), anchor);
-        if (dist < best_dist)
+        /* The paths are searched from the monster, as a search from the
+           anchor would follow the player's memory of the map if the
+           anchor is the player's position. Try the hostiles in the order
+           of their distance to anchor until one can be reached. */
+        int dist = -1;
+
+        for (;;)
         {
-            best_dist = dist;
-            target = candidate;
+            int next = G_MAXINT;
+
+            for (guint vidx = 0; (candidate = fov_visible_monster(m->fv, vidx)); vidx++)
+            {
+                if (monster_is_friendly(candidate)) continue;
+
+                const int cdist = pos_distance(monster_pos(candidate), anchor);
+                if (cdist > dist && cdist < next)
+                    next = cdist;
+            }
+
+            if (next == G_MAXINT)
+                return NULL;
+
+            dist = next;
+
+            for (guint vidx = 0; (candidate = fov_visible_monster(m->fv, vidx)); vidx++)
+            {
+                if (monster_is_friendly(candidate)) continue;
+
+                const position cpos = monster_pos(candidate);
+                if (pos_distance(cpos, anchor) == dist
+                        && path_find_nearest_step(monster_map(m), monster_pos(m),
+                                                  &cpos, 1, monster_map_element(m),
+                                                  step) >= 0)
+                    return candidate;
+            }
         }
     }
-    g_list_free(visible);
+
+    GPtrArray *candidates = g_ptr_array_new();
+    GArray *goals = g_array_new(false, false, sizeof(position));
+
+    for (guint vidx = 0; (candidate = fov_visible_monster(m->fv, vidx)); vidx++)
+    {
+        if (monster_is_friendly(candidate)) continue;
+
+        position cpos = monster_pos(candidate);
+        g_ptr_array_add(candidates, candidate);
+        g_array_append_val(goals, cpos);
+    }
+
+    monster *target = NULL;
+    const gint idx = path_find_nearest_step(monster_map(m), anchor,
+            (position *)goals->data, goals->len, monster_map_element(m),
+            step);
+
+    if (idx >= 0)
+        target = g_ptr_array_index(candidates, idx);
+
+    g_ptr_array_free(candidates, true);
+    g_array_free(goals, true);
+
     return target;
 }
 
-/* Attack target if adjacent, otherwise step toward it.
-   Returns the monster's resulting position. */
-static position monster_engage_or_approach(monster *m, monster *target)
+/* Attack target if adjacent, otherwise step toward it, using step if it is
+   already known. Returns the monster's resulting position. */
+static position monster_engage_or_approach(monster *m, monster *target,
+        position step)
 {
     if (pos_adjacent(m->pos, monster_pos(target)))
     {
         monster_attack_monster(m, target);
         return m->pos;
     }
+
+    if (pos_valid(step))
+        return step;
+
     return monster_find_next_pos_to(m, monster_pos(target));
 }
 
@@ -3906,25 +3974,31 @@ static position monster_move_serve(monster *m, struct player *p)
             case LS_ELEVATORUP:     newmap = 0;             break;
             default:                newmap = Z(m->pos);     break;
             }
-            if (abs(newmap - Z(p->pos)) < abs(Z(m->pos) - Z(p->pos)))
+            /* levels are not generated while the monsters move */
+            if (abs(newmap - Z(p->pos)) < abs(Z(m->pos) - Z(p->pos))
+                    && nlarn->maps[newmap] != NULL)
             {
                 monster_level_enter(m, game_map(nlarn, newmap));
                 return monster_pos(m);
             }
         }
 
-        /* navigate toward the exit that leads to the player's level */
+        /* navigate toward the nearest exit that leads to the player's level */
         bool going_deeper = Z(p->pos) > Z(m->pos);
         const sobject_t down_exits[] = { LS_STAIRSDOWN, LS_CAVERNS_ENTRY, LS_ELEVATORDOWN };
         const sobject_t up_exits[]   = { LS_STAIRSUP, LS_CAVERNS_EXIT, LS_ELEVATORUP };
         const sobject_t *exits = going_deeper ? down_exits : up_exits;
 
+        position exit_pos[3];
         for (int i = 0; i < 3; i++)
-        {
-            position exit_pos = map_find_sobject(mmap, exits[i]);
-            if (pos_valid(exit_pos))
-                return monster_find_next_pos_to(m, exit_pos);
-        }
+            exit_pos[i] = map_find_sobject(mmap, exits[i]);
+
+        position step = pos_invalid;
+        path_find_nearest_step(mmap, monster_pos(m), exit_pos, 3,
+                               monster_map_element(m), &step);
+
+        if (pos_valid(step))
+            npos = step;
 
         return npos;
     }
@@ -3932,10 +4006,11 @@ static position monster_move_serve(monster *m, struct player *p)
     monster_fov_ensure(m);
 
     /* engage the visible hostile closest to the player */
-    monster *target = monster_nearest_hostile_to(m, p->pos);
+    position step;
+    monster *target = monster_nearest_hostile_to(m, p->pos, &step);
 
     if (target != NULL)
-        npos = monster_engage_or_approach(m, target);
+        npos = monster_engage_or_approach(m, target, step);
     else if (pos_distance(monster_pos(m), p->pos) > 2)
         npos = monster_find_next_pos_to(m, p->pos);
 
@@ -3950,7 +4025,8 @@ static position monster_move_civilian(monster *m, struct player *p)
     monster_fov_ensure(m);
 
     /* engage the nearest visible hostile */
-    monster *target = monster_nearest_hostile_to(m, m->pos);
+    position step;
+    monster *target = monster_nearest_hostile_to(m, m->pos, &step);
 
     /* pick up a weapon from the floor when threatened and unarmed */
     if (target != NULL && m->eq_weapon == NULL)
@@ -3994,7 +4070,7 @@ static position monster_move_civilian(monster *m, struct player *p)
     }
 
     if (target != NULL)
-        return monster_engage_or_approach(m, target);
+        return monster_engage_or_approach(m, target, step);
 
     /* civilians will pick a random location on the map, travel and remain
        there for the number of turns that is determined by their town person
@@ -4177,6 +4253,21 @@ inline int monster_type_hp_max(monster_t type)
     return monster_data[type].hp_max;
 }
 
+int monster_type_visrange(monster_t type)
+{
+    /* Some differentiation of the visible range per monster type */
+    int visrange = max(3,
+        5
+        // slower monsters see less, faster more
+        + (((int)monster_data[type].speed - NORMAL) / 25)
+        // flying monsters see further
+        + (monster_type_flags(type, FLY) ? 2 : 0));
+
+    g_assert(visrange <= MONSTER_VISRANGE_MAX);
+
+    return visrange;
+}
+
 inline char monster_type_glyph(monster_t type)
 {
     return monster_data[type].glyph;
@@ -4188,7 +4279,7 @@ inline int monster_type_reroll_chance(monster_t type)
 }
 
 
-static bool monster_breath_hit(const GList *traj,
+static bool monster_breath_hit(const position *traj, guint step,
                                    const damage_originator *damo __attribute__((unused)),
                                    gpointer data1,
                                    gpointer data2 __attribute__((unused)))
@@ -4197,7 +4288,7 @@ static bool monster_breath_hit(const GList *traj,
     damage *dam = (damage *)data1;
     item_erosion_type iet;
     bool terminated = false;
-    position pos; pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
     map *mp = game_map(nlarn, Z(pos));
 
     /* determine if items should be eroded */
@@ -228,6 +228,14 @@ static void nlarn_init(int argc, char *argv[])
     nlarn_mazefile = g_build_filename(nlarn_libdir, mazefile, NULL);
     nlarn_fortunes = locale_filename(fortunes);
 
+    /* load the predefined levels */
+    char *maze_error = map_mazes_load(nlarn_mazefile);
+    if (maze_error != NULL)
+    {
+        g_printerr("%s\n\nPlease reinstall the game.\n", maze_error);
+        exit(EXIT_FAILURE);
+    }
+
     /*
      * We need to parse the command line here, as we might get a custom
      * user directory here before using nlarn_userdir() for the first time.
@@ -365,6 +373,13 @@ static void mainloop()
     /* position chosen for auto travel, allowing to continue travel */
     position cpos = pos_invalid;
 
+    /* the route followed in travel mode and the destination it leads to */
+    path *route = NULL;
+    position route_dest = pos_invalid;
+
+    /* the map travel mode is expected to continue on */
+    int travel_level = -1;
+
     int run_cmd = 0;
     int ch = 0;
     bool adj_corr = false;
@@ -377,14 +392,24 @@ static void mainloop()
         /* repaint screen */
         display_paint_screen(nlarn->p);
 
+        /* forget the route when travel has ended */
+        if (!pos_valid(pos))
+        {
+            if (route) path_destroy(route);
+            route = NULL;
+            travel_level = -1;
+        }
+
         if (pos_valid(pos))
         {
             /* travel mode */
+            if (travel_level < 0)
+                travel_level = Z(nlarn->p->pos);
 
             /* check if travel mode shall be aborted:
                attacked or fell through trap door */
             GList *threats;
-            if (nlarn->p->attacked || Z(pos) != Z(nlarn->p->pos))
+            if (nlarn->p->attacked || travel_level != Z(nlarn->p->pos))
             {
                 pos = pos_invalid;
             }
@@ -405,14 +430,27 @@ static void mainloop()
             }
             else
             {
-                /* find a path to the destination */
-                path *path = path_find(game_map(nlarn, Z(nlarn->p->pos)),
-                                       nlarn->p->pos, pos, LE_GROUND);
+                /* keep following the known route unless something
+                   the player knows of has changed along it */
+                if (route && !(pos_identical(route_dest, pos)
+                               && path_player_route_valid(route)))
+                {
+                    path_destroy(route);
+                    route = NULL;
+                }
+
+                /* find a path to the destination, which might be on
+                   another map */
+                if (route == NULL)
+                {
+                    route = path_find_journey(pos);
+                    route_dest = pos;
+                }
 
-                if (path && !g_queue_is_empty(path->path))
+                if (route && !g_queue_is_empty(route->path))
                 {
                     /* Path found. Move the player. */
-                    path_element *el = g_queue_pop_head(path->path);
+                    path_element *el = g_queue_pop_head(route->path);
                     moves_count = player_move(nlarn->p, pos_dir(nlarn->p->pos, el->pos), true);
 
                     if (moves_count == 0)
@@ -422,14 +460,37 @@ static void mainloop()
                         pos = pos_invalid;
                     }
                 }
+                else if (route && Z(pos) != Z(nlarn->p->pos)
+                         && pos_identical(route->goal, nlarn->p->pos))
+                {
+                    /* standing on the exit leading towards the destination */
+                    switch (map_sobject_at(game_map(nlarn, Z(nlarn->p->pos)),
+                                           nlarn->p->pos))
+                    {
+                    case LS_STAIRSDOWN:
+                    case LS_ELEVATORDOWN:
+                    case LS_CAVERNS_ENTRY:
+                        moves_count = player_stairs_down(nlarn->p);
+                        break;
+
+                    default:
+                        moves_count = player_stairs_up(nlarn->p);
+                        break;
+                    }
+
+                    path_destroy(route);
+                    route = NULL;
+
+                    if (moves_count == 0)
+                        pos = pos_invalid;
+                    else
+                        travel_level = Z(nlarn->p->pos);
+                }
                 else
                 {
                     /* No path found. Stop traveling */
                     pos = pos_invalid;
                 }
-
-                /* clean up */
-                if (path) path_destroy(path);
             }
         }
         else if (run_cmd != 0)
@@ -783,17 +844,14 @@ static void mainloop()
                        single tile per click lets the player still
                        approach for melee while keeping the danger in
                        view. Pathfinding routes the step around walls. */
-                    path *pth = path_find(cmap, nlarn->p->pos, mpos, LE_GROUND);
+                    position step = path_find_step(cmap, nlarn->p->pos,
+                                                   mpos, LE_GROUND);
 
-                    if (pth != NULL && !g_queue_is_empty(pth->path))
+                    if (pos_valid(step))
                     {
-                        path_element *el = g_queue_pop_head(pth->path);
                         moves_count = player_move(nlarn->p,
-                                pos_dir(nlarn->p->pos, el->pos), true);
+                                pos_dir(nlarn->p->pos, step), true);
                     }
-
-                    if (pth != NULL)
-                        path_destroy(pth);
                 }
             }
             else if (!pos_identical(mpos, nlarn->p->pos))
@@ -907,14 +965,8 @@ static void mainloop()
             }
             break;
 
-            /* continue auto travel */
+            /* continue auto travel, possibly to another map */
         case 'V':
-            /* delete last auto travel target if it was on another map */
-            if (Z(cpos) != Z(nlarn->p->pos))
-            {
-                cpos = pos_invalid;
-            }
-
             if (pos_valid(cpos))
             {
                 /* restore last known auto travel position */
@@ -1114,6 +1166,15 @@ static void mainloop()
                 calc_fighting_stats(nlarn->p);
             break;
 
+        case 7: /* ^G */
+            if (game_wizardmode(nlarn))
+            {
+                char *stats = map_generation_stats_describe();
+                display_show_message(_("Level generation"), stats, 0);
+                g_free(stats);
+            }
+            break;
+
         default:
             break;
         }
@@ -1182,6 +1243,8 @@ static void mainloop()
             }
         }
     }
+
+    if (route) path_destroy(route);
 }
 
 bool main_menu()
@@ -16,304 +16,1841 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "extdefs.h"
 #include "pathfinding.h"
 #include "player.h"
 #include "spheres.h"
 
-static path *path_new(position start, position goal);
-static path_element *path_element_new(position pos);
-static guint path_step_cost(map *m, const path_element* element,
-    map_element_t map_elem, bool for_player);
-static guint path_cost(path_element* element, position target);
-static path_element *path_element_in_list(const path_element* el, const GPtrArray *list);
-static path_element *path_find_best(const path *pt);
-static GPtrArray *path_get_neighbours(map *m, position pos,
-    map_element_t element, bool for_player, position goal);
+/* Search state of a single map tile */
+typedef enum path_node_state
+{
+    PN_UNSEEN,
+    PN_OPEN,
+    PN_CLOSED
+} path_node_state;
+
+typedef struct path_node
+{
+    guint32 search;   /* number of the search that touched the node last */
+    guint32 g_score;
+    guint32 h_score;
+    gint16 parent;    /* index of the predecessor, -1 for the start */
+    guint16 slot;     /* position in the open list */
+    guint16 heap_idx; /* position in the open heap */
+    guint8 state;
+    guint8 goal;      /* the node is one of the goals searched for */
+} path_node;
+
+/*
+ * The node table is indexed by the tile's offset on the map and reused by
+ * every search. Nodes from previous searches are recognised by their
+ * outdated search number, thus the table never has to be cleared.
+ *
+ * The open set is a binary heap ordered by the estimated total cost.
+ * Ties are broken by the open list slot: open nodes are appended to the
+ * list and a removed node's slot is filled with the last one. Preferring
+ * the lowest slot picks the very node the former linear scan over the
+ * open list picked, which keeps the paths found unchanged.
+ */
+static struct
+{
+    guint32 search;
+    path_node nodes[MAP_SIZE];
+    guint16 slots[MAP_SIZE];
+    guint slots_len;
+    guint16 heap[MAP_SIZE];
+    guint heap_len;
+} pf;
+
+/*
+ * Distance fields are shared by all walkers heading to the same target
+ * during a turn. Each entry holds the cost of the cheapest route from the
+ * tile to the target, not counting the cost of entering the tile itself.
+ *
+ * The flee field is derived from the distances: they are scaled by -1.2
+ * and spread out again. Walking downhill leads away from the target, but
+ * prefers routes which do not end in a dead end.
+ */
+#define PATH_FIELD_INF G_MAXINT32
+
+typedef struct path_field
+{
+    map *m;                 /* the map the field has been built for */
+    guint32 gtime;          /* the game turn the field has been built in */
+    position target;
+    gint32 dist[MAP_SIZE];
+    bool flee_built;        /* the flee field is up to date */
+    gint32 flee[MAP_SIZE];
+} path_field;
+
+static path_field *pfields[LE_MAX];
+
+/* the priority queue used to build distance fields */
+static struct
+{
+    const gint32 *key;
+    guint16 heap[MAP_SIZE];
+    gint16 heap_idx[MAP_SIZE]; /* -1 for tiles not queued */
+    guint len;
+} fq;
+
+/*
+ * The exits of each map known to the player and the costs of the paths
+ * between them. The exits are looked up again whenever the player's memory
+ * of the map has changed; the costs are determined when needed first.
+ */
+#define PATH_EXITS_MAX 4
+#define PATH_COST_UNKNOWN -1
+
+typedef struct path_level
+{
+    guint32 plan;           /* the last journey the memory was checked for */
+    guint32 memory_hash;    /* checksum of the player's memory of the map */
+    guint count;
+    position exits[PATH_EXITS_MAX];
+    sobject_t sobjects[PATH_EXITS_MAX];
+    gint32 cost[PATH_EXITS_MAX][PATH_EXITS_MAX];
+} path_level;
+
+static struct
+{
+    guint32 plan;
+    path_level levels[MAP_MAX];
+} pj;
+
+static void path_search_begin();
+/*
+ * Incremental planning of the player's travels (D* Lite). The search runs
+ * from the goal towards the player. When the costs of tiles change, e.g.
+ * as the player learns more about the map, only the part of the search
+ * affected by the change is repaired.
+ */
+#define PATH_DSTAR_INF G_MAXUINT32
+#define PATH_DSTAR_UNKNOWN (G_MAXUINT32 - 1)
+
+typedef struct path_dstar_node
+{
+    guint32 g;          /* cost of the path from the tile to the goal */
+    guint32 rhs;        /* the lookahead value of g */
+    guint32 cost;       /* cost of entering the tile as used by the search */
+    guint32 key[2];
+    gint16 heap_idx;    /* position in the queue, -1 if not queued */
+} path_dstar_node;
+
+static struct
+{
+    map *m;             /* the map of the current search, NULL if none */
+    position goal;
+    position start;
+    position last;      /* the start of the previous search */
+    guint32 km;         /* key modifier for the starts moved since */
+    path_dstar_node nodes[MAP_SIZE];
+    map_tile_t tiles[MAP_SIZE];  /* the player's memory when last updated */
+    trap_t traps[MAP_SIZE];
+    guint16 occupied[MAP_SIZE];  /* tiles with visible monsters or spheres */
+    guint occupied_len;
+    guint16 heap[MAP_SIZE];
+    guint heap_len;
+} pd;
+
+/* the number of nodes expanded by the last search */
+static guint path_expanded;
+
+/* the queue used to label the connected areas of a map */
+static guint16 cq[MAP_SIZE];
+
+static gint path_search(map *m, position start, position goal,
+    map_element_t element, bool for_player);
+static guint32 path_nearest_estimate(position pos, const position *goals,
+    guint count);
+static gint path_find_goal(map *m, position start, position goal,
+    map_element_t element, bool for_player);
+static gint path_search_nearest(map *m, position start,
+    const position *goals, guint count, map_element_t element,
+    bool for_player);
+static path *path_new(position start, position goal, guint goal_idx,
+    bool for_player);
+static guint path_trace(guint goal_idx, guint32 nlevel, position *steps,
+    guint capacity);
+static path_level *path_level_get(int nlevel);
+static gint32 path_level_cost(int nlevel, guint from, guint to);
+static gint32 path_player_cost(int nlevel, position from, position to);
+static bool path_exit_leads_to(int nlevel, sobject_t exit, int *dest_level,
+    sobject_t *dest_exit);
+static guint path_step_cost(map *m, position pos,
+    map_element_t map_elem, bool for_player);
+static bool path_sphere_at(position pos);
+static bool path_reachable(map *m, position start, position goal,
+    map_element_t element);
+static const guint16 *path_components(map *m, map_element_t element);
+static void path_dstar_init(map *m, position start, position goal);
+static void path_dstar_update_costs();
+static void path_dstar_cost_changed(guint idx);
+static guint32 path_dstar_cost(guint idx);
+static void path_dstar_update_vertex(guint idx);
+static void path_dstar_compute();
+static guint path_dstar_neighbours(guint idx, guint neighbours[GD_MAX]);
+static void path_dstar_queue_insert(guint idx);
+static void path_dstar_queue_remove(guint idx);
+static path_node *path_node_get(guint idx);
+static void path_open_push(guint idx);
+static guint path_open_pop();
+static void path_heap_up(guint hpos);
+static void path_heap_down(guint hpos);
+static guint path_get_neighbours(map *m, position pos,
+    map_element_t element, bool for_player, const position *goals,
+    guint goal_count, position neighbours[GD_MAX]);
+static path_field *path_field_get(map *m, position target,
+    map_element_t element);
+static void path_field_build(path_field *f, map *m, position target,
+    map_element_t element);
+static void path_field_build_flee(path_field *f, map *m,
+    map_element_t element);
+static void path_field_spread(gint32 *field, map *m, position target,
+    map_element_t element, bool enter_target);
+static void path_field_queue_update(guint idx);
+static guint path_field_queue_pop();
+
+static inline guint path_node_idx(position pos)
+{
+    return Y(pos) * MAP_MAX_X + X(pos);
+}
+
+static inline position path_node_pos(guint idx, guint32 nlevel)
+{
+    position pos = pos_invalid;
+
+    X(pos) = idx % MAP_MAX_X;
+    Y(pos) = idx / MAP_MAX_X;
+    Z(pos) = nlevel;
+
+    return pos;
+}
+
+path *path_find(map *m, position start, position goal, map_element_t element)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(start));
+    g_assert(pos_valid(goal));
+    g_assert(element < LE_MAX);
+
+    /* check if the path is being determined for the player */
+    bool for_player = pos_identical(start, nlarn->p->pos);
+
+    const gint goal_idx = path_find_goal(m, start, goal, element, for_player);
+
+    if (goal_idx < 0)
+        return NULL;
+
+    return path_new(start, goal, goal_idx, for_player);
+}
+
+gint path_find_steps(map *m, position start, position goal,
+                     map_element_t element, position *steps, guint capacity)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(start));
+    g_assert(pos_valid(goal));
+    g_assert(element < LE_MAX);
+    g_assert(steps != NULL || capacity == 0);
+
+    bool for_player = pos_identical(start, nlarn->p->pos);
+
+    const gint goal_idx = path_find_goal(m, start, goal, element, for_player);
+
+    if (goal_idx < 0)
+        return -1;
+
+    return path_trace(goal_idx, Z(start), steps, capacity);
+}
+
+position path_find_step(map *m, position start, position goal,
+                        map_element_t element)
+{
+    position step = pos_invalid;
+
+    path_find_steps(m, start, goal, element, &step, 1);
+
+    return step;
+}
+
+path *path_find_nearest(map *m, position start, const position *goals,
+                        guint count, map_element_t element)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(start));
+    g_assert(goals != NULL || count == 0);
+    g_assert(element < LE_MAX);
+
+    bool for_player = pos_identical(start, nlarn->p->pos);
+
+    const gint goal_idx = path_search_nearest(m, start, goals, count,
+                                              element, for_player);
+
+    if (goal_idx < 0)
+        return NULL;
+
+    return path_new(start, path_node_pos(goal_idx, Z(start)), goal_idx,
+                    for_player);
+}
+
+gint path_find_nearest_step(map *m, position start, const position *goals,
+                            guint count, map_element_t element,
+                            position *step)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(start));
+    g_assert(goals != NULL || count == 0);
+    g_assert(element < LE_MAX);
+
+    bool for_player = pos_identical(start, nlarn->p->pos);
+
+    const gint goal_idx = path_search_nearest(m, start, goals, count,
+                                              element, for_player);
+
+    if (step != NULL)
+        *step = pos_invalid;
+
+    if (goal_idx < 0)
+        return -1;
+
+    if (step != NULL)
+        path_trace(goal_idx, Z(start), step, 1);
+
+    /* the first of the goals on the tile reached */
+    const position goal = path_node_pos(goal_idx, Z(start));
+
+    for (guint i = 0; i < count; i++)
+    {
+        if (pos_identical(goals[i], goal))
+            return i;
+    }
+
+    g_assert_not_reached();
+    return -1;
+}
+
+/* search a path on the map, returning the index of the goal's node or -1
+   if the goal can not be reached */
+static gint path_find_goal(map *m, position start, position goal,
+                           map_element_t element, bool for_player)
+{
+    /* paths to other maps are found by path_find_journey() */
+    if (Z(start) != Z(goal))
+        return -1;
+
+    /* the player's paths follow the memory of the map, not the map itself */
+    if (!for_player && !path_reachable(m, start, goal, element))
+        return -1;
+
+    return path_search(m, start, goal, element, for_player);
+}
+
+/* search the nearest goal, returning the index of its node or -1 if none
+   of the goals can be reached */
+static gint path_search_nearest(map *m, position start,
+                                const position *goals, guint count,
+                                map_element_t element, bool for_player)
+{
+    path_search_begin();
+
+    /* goals on other maps or in other parts of the map can not be reached */
+    guint reachable = 0;
+    for (guint i = 0; i < count; i++)
+    {
+        if (pos_valid(goals[i]) && Z(goals[i]) == Z(start)
+                && (for_player || path_reachable(m, start, goals[i], element)))
+        {
+            path_node_get(path_node_idx(goals[i]))->goal = true;
+            reachable++;
+        }
+    }
+
+    if (reachable == 0)
+        return -1;
+
+    const guint start_idx = path_node_idx(start);
+    path_node *sn = path_node_get(start_idx);
+    sn->h_score = path_nearest_estimate(start, goals, count);
+    path_open_push(start_idx);
+
+    /* unlike path_find(), cheaper routes found later on replace the first
+       one, thus the nearest goal is found */
+    while (pf.heap_len)
+    {
+        const guint curr_idx = path_open_pop();
+        path_node *curr = &pf.nodes[curr_idx];
+        curr->state = PN_CLOSED;
+        path_expanded++;
+
+        if (curr->goal)
+            return curr_idx;
+
+        const position cpos = path_node_pos(curr_idx, Z(start));
+        position neighbours[GD_MAX];
+        guint ncount = path_get_neighbours(m, cpos, element, for_player,
+                                           goals, count, neighbours);
+
+        while (ncount--)
+        {
+            const guint next_idx = path_node_idx(neighbours[ncount]);
+            path_node *next = path_node_get(next_idx);
+
+            if (next->state == PN_CLOSED)
+                continue;
+
+            const guint32 g_score = curr->g_score + path_step_cost(m,
+                    neighbours[ncount], element, for_player);
+
+            if (next->state == PN_OPEN && g_score >= next->g_score)
+                continue;
+
+            next->parent  = curr_idx;
+            next->g_score = g_score;
+
+            if (next->state == PN_OPEN)
+            {
+                path_heap_up(next->heap_idx);
+            }
+            else
+            {
+                next->h_score = path_nearest_estimate(neighbours[ncount],
+                                                      goals, count);
+                path_open_push(next_idx);
+            }
+        }
+    }
+
+    /* none of the goals can be reached */
+    return -1;
+}
+
+/* start a new search; clear the node table when the counter wraps */
+static void path_search_begin()
+{
+    if (++pf.search == 0)
+    {
+        memset(pf.nodes, 0, sizeof(pf.nodes));
+        pf.search = 1;
+    }
+
+    pf.slots_len = pf.heap_len = 0;
+    path_expanded = 0;
+}
+
+/* A* search, returns the index of the goal's node or -1 */
+static gint path_search(map *m, position start, position goal,
+                        map_element_t element, bool for_player)
+{
+    path_search_begin();
+
+    /* add start to open list */
+    const guint start_idx = path_node_idx(start);
+    path_node *sn = path_node_get(start_idx);
+    sn->h_score = pos_distance(start, goal);
+    path_open_push(start_idx);
+
+    while (pf.heap_len)
+    {
+        const guint curr_idx = path_open_pop();
+        path_node *curr = &pf.nodes[curr_idx];
+        curr->state = PN_CLOSED;
+        path_expanded++;
+
+        const position cpos = path_node_pos(curr_idx, Z(start));
+
+        if (pos_identical(cpos, goal))
+        {
+            /* arrived at goal */
+            return curr_idx;
+        }
+
+        position neighbours[GD_MAX];
+        guint count = path_get_neighbours(m, cpos, element, for_player,
+                                          &goal, 1, neighbours);
+
+        /* neighbours are evaluated last to first */
+        while (count--)
+        {
+            const guint next_idx = path_node_idx(neighbours[count]);
+            path_node *next = path_node_get(next_idx);
+
+            /* The first route to a node determines its parent. Its score
+               is not lowered when a cheaper route shows up later on. */
+            if (next->state != PN_UNSEEN)
+                continue;
+
+            next->parent  = curr_idx;
+            next->g_score = curr->g_score + path_step_cost(m,
+                    neighbours[count], element, for_player);
+            next->h_score = pos_distance(neighbours[count], goal);
+
+            path_open_push(next_idx);
+        }
+    }
+
+    /* could not find a path */
+    return -1;
+}
+
+void path_destroy(path *path)
+{
+    g_assert(path != NULL);
+
+    g_queue_free(path->path);
+    g_free(path->steps);
+    g_free(path);
+}
+
+path *path_find_incremental(map *m, position start, position goal)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(start));
+    g_assert(pos_valid(goal));
+
+    if (Z(start) != Z(goal))
+        return NULL;
+
+    if (pd.m != m || !pos_identical(pd.goal, goal))
+    {
+        path_dstar_init(m, start, goal);
+    }
+    else
+    {
+        /* the keys of queued nodes refer to the previous start */
+        pd.km += path_nearest_estimate(pd.last, &start, 1);
+        pd.start = pd.last = start;
+        path_dstar_update_costs();
+    }
+
+    path_expanded = 0;
+    path_dstar_compute();
+
+    /* tracing the path below resets the counter */
+    const guint expanded = path_expanded;
+
+    const guint goal_idx = path_node_idx(goal);
+    guint idx = path_node_idx(start);
+
+    if (pd.nodes[idx].rhs == PATH_DSTAR_INF)
+        return NULL;
+
+    /* trace the path by following the lowest costs and store it in the
+       node table of the A* search to build the path from there */
+    path_search_begin();
+
+    path_node *node = path_node_get(idx);
+    guint steps = 0;
+
+    while (idx != goal_idx)
+    {
+        guint neighbours[GD_MAX];
+        guint count = path_dstar_neighbours(idx, neighbours);
+        guint32 best = PATH_DSTAR_INF;
+        guint next = idx;
+
+        for (guint i = 0; i < count; i++)
+        {
+            const guint32 cost = path_dstar_cost(neighbours[i]);
+            const guint32 g = pd.nodes[neighbours[i]].g;
+
+            if (cost == PATH_DSTAR_INF || g == PATH_DSTAR_INF)
+                continue;
+
+            if (cost + g < best)
+            {
+                best = cost + g;
+                next = neighbours[i];
+            }
+        }
+
+        /* a dead end or a loop, which the search should have prevented */
+        if (next == idx || ++steps > MAP_SIZE)
+            return path_find(m, start, goal, LE_GROUND);
+
+        path_node *nnode = path_node_get(next);
+        nnode->parent  = idx;
+        nnode->g_score = node->g_score + path_dstar_cost(next);
+
+        idx  = next;
+        node = nnode;
+    }
+
+    path_expanded = expanded;
+
+    return path_new(start, goal, goal_idx, true);
+}
+
+guint path_expansions()
+{
+    return path_expanded;
+}
+
+path *path_find_journey(position goal)
+{
+    g_assert(pos_valid(goal));
+
+    const position start = nlarn->p->pos;
+    map *smap = game_map(nlarn, Z(start));
+
+    if (Z(start) == Z(goal))
+        return path_find_incremental(smap, start, goal);
+
+    /* a new plan: the player's memory of each map is checked once */
+    if (++pj.plan == 0)
+    {
+        memset(pj.levels, 0, sizeof(pj.levels));
+        pj.plan = 1;
+    }
+
+    /* Dijkstra's algorithm over the exits of all maps. For each exit, the
+       exit on the start map the journey begins with is remembered. */
+    gint32 cost[MAP_MAX][PATH_EXITS_MAX];
+    gint first[MAP_MAX][PATH_EXITS_MAX];
+    bool done[MAP_MAX][PATH_EXITS_MAX] = { { false } };
+
+    for (int nlevel = 0; nlevel < MAP_MAX; nlevel++)
+        for (guint idx = 0; idx < PATH_EXITS_MAX; idx++)
+            cost[nlevel][idx] = PATH_FIELD_INF;
+
+    path_level *sl = path_level_get(Z(start));
+
+    for (guint idx = 0; idx < sl->count; idx++)
+    {
+        cost[Z(start)][idx] = path_player_cost(Z(start), start, sl->exits[idx]);
+        first[Z(start)][idx] = idx;
+    }
+
+    gint32 best = PATH_FIELD_INF;
+    gint best_first = -1;
+
+    while (true)
+    {
+        /* pick the cheapest exit not visited yet */
+        int nlevel = -1;
+        guint exit = 0;
+
+        for (int l = 0; l < MAP_MAX; l++)
+        {
+            for (guint idx = 0; idx < PATH_EXITS_MAX; idx++)
+            {
+                if (!done[l][idx] && cost[l][idx] < best
+                        && (nlevel < 0 || cost[l][idx] < cost[nlevel][exit]))
+                {
+                    nlevel = l;
+                    exit = idx;
+                }
+            }
+        }
+
+        /* no cheaper journey left */
+        if (nlevel < 0)
+            break;
+
+        done[nlevel][exit] = true;
+
+        const gint32 curr = cost[nlevel][exit];
+        path_level *lv = path_level_get(nlevel);
+
+        /* arrived on the goal's map */
+        if (nlevel == Z(goal))
+        {
+            const gint32 rest = path_player_cost(nlevel, lv->exits[exit], goal);
+
+            if (rest != PATH_FIELD_INF && curr + rest < best)
+            {
+                best = curr + rest;
+                best_first = first[nlevel][exit];
+            }
+        }
+
+        /* walk to the other exits of the map */
+        for (guint idx = 0; idx < lv->count; idx++)
+        {
+            if (idx == exit || done[nlevel][idx])
+                continue;
+
+            const gint32 walk = path_level_cost(nlevel, exit, idx);
+
+            if (walk != PATH_FIELD_INF && curr + walk < cost[nlevel][idx])
+            {
+                cost[nlevel][idx] = curr + walk;
+                first[nlevel][idx] = first[nlevel][exit];
+            }
+        }
+
+        /* take the exit */
+        int dest_level;
+        sobject_t dest_exit;
+
+        if (!path_exit_leads_to(nlevel, lv->sobjects[exit], &dest_level,
+                                &dest_exit))
+        {
+            continue;
+        }
+
+        path_level *dl = path_level_get(dest_level);
+
+        for (guint idx = 0; idx < dl->count; idx++)
+        {
+            if (dl->sobjects[idx] == dest_exit && !done[dest_level][idx]
+                    && curr + 1 < cost[dest_level][idx])
+            {
+                cost[dest_level][idx] = curr + 1;
+                first[dest_level][idx] = first[nlevel][exit];
+            }
+        }
+    }
+
+    if (best_first < 0)
+        return NULL;
+
+    return path_find_incremental(smap, start, sl->exits[best_first]);
+}
+
+position path_field_next_step(map *m, position pos, position target,
+                               map_element_t element)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(pos));
+    g_assert(pos_valid(target));
+    g_assert(element < LE_MAX);
+
+    if (Z(pos) != Z(target))
+        return pos;
+
+    path_field *f = path_field_get(m, target, element);
+
+    /* step to the neighbour with the lowest remaining cost */
+    position npos = pos;
+    gint64 best = PATH_FIELD_INF;
+
+    position neighbours[GD_MAX];
+    guint count = path_get_neighbours(m, pos, element, false, &target, 1,
+                                      neighbours);
+
+    for (guint i = 0; i < count; i++)
+    {
+        const gint32 dist = f->dist[path_node_idx(neighbours[i])];
+
+        if (dist == PATH_FIELD_INF)
+            continue;
+
+        gint64 cost = dist;
+        if (!pos_identical(neighbours[i], target))
+            cost += path_step_cost(m, neighbours[i], element, false);
+
+        if (cost < best)
+        {
+            best = cost;
+            npos = neighbours[i];
+        }
+    }
+
+    return npos;
+}
+
+position path_field_flee_step(map *m, position pos, position target,
+                               map_element_t element)
+{
+    g_assert(m != NULL);
+    g_assert(pos_valid(pos));
+    g_assert(pos_valid(target));
+    g_assert(element < LE_MAX);
+
+    if (Z(pos) != Z(target))
+        return pos_invalid;
+
+    path_field *f = path_field_get(m, target, element);
+
+    if (!f->flee_built)
+        path_field_build_flee(f, m, element);
+
+    const gint32 here = f->flee[path_node_idx(pos)];
+
+    if (here == PATH_FIELD_INF)
+        return pos_invalid;
+
+    /* step to the neighbour with the lowest value unless staying is safer;
+       the target is never a valid step */
+    position npos = pos;
+    gint64 best = here;
+
+    position neighbours[GD_MAX];
+    guint count = path_get_neighbours(m, pos, element, false, NULL, 0,
+                                      neighbours);
+
+    for (guint i = 0; i < count; i++)
+    {
+        const gint32 flee = f->flee[path_node_idx(neighbours[i])];
+
+        if (flee == PATH_FIELD_INF)
+            continue;
+
+        const gint64 cost = flee
+            + path_step_cost(m, neighbours[i], element, false);
+
+        if (cost <= best)
+        {
+            best = cost;
+            npos = neighbours[i];
+        }
+    }
+
+    return npos;
+}
+
+void path_fields_clear()
+{
+    for (guint element = 0; element < LE_MAX; element++)
+    {
+        g_free(pfields[element]);
+        pfields[element] = NULL;
+    }
+
+    /* forget the exits known from the previous game */
+    memset(pj.levels, 0, sizeof(pj.levels));
+
+    /* and the player's last travel */
+    pd.m = NULL;
+}
+
+bool path_player_route_valid(path *pth)
+{
+    g_assert(pth != NULL);
+
+    if (g_queue_is_empty(pth->path))
+        return false;
+
+    /* the player must stand where the next step begins */
+    path_element *next = g_queue_peek_head(pth->path);
+    position from = next->parent ? next->parent->pos : pth->start;
+
+    if (!pos_identical(from, nlarn->p->pos))
+        return false;
+
+    map *m = game_map(nlarn, Z(pth->goal));
+
+    for (GList *iter = pth->path->head; iter != NULL; iter = iter->next)
+    {
+        path_element *el = iter->data;
+        player_tile_memory *mem = &player_memory_of(nlarn->p, el->pos);
+
+        if (mem->type != el->tile || mem->trap != el->trap)
+            return false;
+
+        monster *mon = map_get_monster_at(m, el->pos);
+        if (mon != NULL && monster_in_sight(mon))
+            return false;
+    }
+
+    return true;
+}
+
+static path *path_new(position start, position goal, guint goal_idx,
+                      bool for_player)
+{
+    g_assert(pos_valid(start));
+    g_assert(pos_valid(goal));
+
+    path *pt = g_malloc0(sizeof(path));
+
+    pt->path  = g_queue_new();
+    pt->start = start;
+    pt->goal  = goal;
+
+    /* count the steps, the starting point is not part of the path */
+    guint len = 0;
+    for (gint idx = goal_idx; pf.nodes[idx].parent >= 0; idx = pf.nodes[idx].parent)
+        len++;
+
+    pt->steps = g_new0(path_element, len);
+
+    gint idx = goal_idx;
+    for (guint step = len; step > 0; step--)
+    {
+        path_element *el = &pt->steps[step - 1];
+
+        el->pos     = path_node_pos(idx, Z(start));
+        el->g_score = pf.nodes[idx].g_score;
+        el->h_score = pf.nodes[idx].h_score;
+        el->parent  = (step > 1) ? &pt->steps[step - 2] : NULL;
+
+        if (for_player)
+        {
+            el->tile = player_memory_of(nlarn->p, el->pos).type;
+            el->trap = player_memory_of(nlarn->p, el->pos).trap;
+        }
+
+        g_queue_push_head(pt->path, el);
+        idx = pf.nodes[idx].parent;
+    }
+
+    return pt;
+}
+
+/* copy the first steps of the path leading to the goal node to steps and
+   return the number of steps of the entire path */
+static guint path_trace(guint goal_idx, guint32 nlevel, position *steps,
+                        guint capacity)
+{
+    /* the starting point is not part of the path */
+    guint len = 0;
+    for (gint idx = goal_idx; pf.nodes[idx].parent >= 0; idx = pf.nodes[idx].parent)
+        len++;
+
+    gint idx = goal_idx;
+    for (guint step = len; step > 0; step--)
+    {
+        if (step <= capacity)
+            steps[step - 1] = path_node_pos(idx, nlevel);
+
+        idx = pf.nodes[idx].parent;
+    }
+
+    return len;
+}
+
+/* get the known exits of a map, looking them up again if the player's
+   memory of the map has changed */
+static path_level *path_level_get(int nlevel)
+{
+    path_level *lv = &pj.levels[nlevel];
+
+    if (lv->plan == pj.plan)
+        return lv;
+
+    lv->plan = pj.plan;
+
+    /* FNV-1a checksum of everything that affects the player's paths */
+    guint32 hash = 2166136261u;
+    position pos = pos_invalid;
+    Z(pos) = nlevel;
+
+    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+    {
+        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        {
+            const player_tile_memory *mem = &player_memory_of(nlarn->p, pos);
+
+            hash = (hash ^ mem->type) * 16777619u;
+            hash = (hash ^ mem->sobject) * 16777619u;
+            hash = (hash ^ mem->trap) * 16777619u;
+        }
+    }
+
+    if (lv->count > 0 && hash == lv->memory_hash)
+        return lv;
+
+    lv->memory_hash = hash;
+    lv->count = 0;
+
+    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
+    {
+        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        {
+            const sobject_t so = player_memory_of(nlarn->p, pos).sobject;
+            int dest_level;
+            sobject_t dest_exit;
+
+            if (lv->count < PATH_EXITS_MAX
+                    && path_exit_leads_to(nlevel, so, &dest_level, &dest_exit))
+            {
+                lv->exits[lv->count] = pos;
+                lv->sobjects[lv->count] = so;
+                lv->count++;
+            }
+        }
+    }
+
+    for (guint from = 0; from < PATH_EXITS_MAX; from++)
+        for (guint to = 0; to < PATH_EXITS_MAX; to++)
+            lv->cost[from][to] = PATH_COST_UNKNOWN;
+
+    return lv;
+}
+
+/* the cost of the player's path between two exits of a map */
+static gint32 path_level_cost(int nlevel, guint from, guint to)
+{
+    path_level *lv = &pj.levels[nlevel];
+
+    if (lv->cost[from][to] == PATH_COST_UNKNOWN)
+    {
+        lv->cost[from][to] = path_player_cost(nlevel, lv->exits[from],
+                                              lv->exits[to]);
+    }
+
+    return lv->cost[from][to];
+}
+
+/* the cost of the player's path between two positions on a map */
+static gint32 path_player_cost(int nlevel, position from, position to)
+{
+    const gint idx = path_search(game_map(nlarn, nlevel), from, to,
+                                 LE_GROUND, true);
+
+    return (idx < 0) ? PATH_FIELD_INF : (gint32)pf.nodes[idx].g_score;
+}
+
+/* determine the map an exit leads to and the exit arrived at there */
+static bool path_exit_leads_to(int nlevel, sobject_t exit, int *dest_level,
+                               sobject_t *dest_exit)
+{
+    switch (exit)
+    {
+    case LS_STAIRSDOWN:
+        *dest_level = nlevel + 1;
+        *dest_exit = LS_STAIRSUP;
+        return true;
+
+    case LS_STAIRSUP:
+        *dest_level = nlevel - 1;
+        *dest_exit = (nlevel == 1) ? LS_CAVERNS_ENTRY : LS_STAIRSDOWN;
+        return true;
+
+    case LS_ELEVATORDOWN:
+        *dest_level = MAP_CMAX;
+        *dest_exit = LS_ELEVATORUP;
+        return true;
+
+    case LS_ELEVATORUP:
+        *dest_level = 0;
+        *dest_exit = LS_ELEVATORDOWN;
+        return true;
+
+    case LS_CAVERNS_ENTRY:
+        /* only the entrance in town leads into the caverns */
+        *dest_level = 1;
+        *dest_exit = LS_CAVERNS_EXIT;
+        return (nlevel == 0);
+
+    case LS_CAVERNS_EXIT:
+        *dest_level = 0;
+        *dest_exit = LS_CAVERNS_ENTRY;
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+/* calculate the cost of stepping into this new field */
+static guint path_step_cost(map *m, position pos,
+    map_element_t map_elem, bool for_player)
+{
+    map_tile_t tt;
+    guint32 step_cost = 1; /* at least 1 movement cost */
+
+    /* get the tile type of the map tile */
+    if (for_player)
+    {
+        tt = player_memory_of(nlarn->p, pos).type ;
+    }
+    else
+    {
+        tt = map_tiletype_at(m, pos);
+    }
+
+    /* penalize for traps known to the player */
+    if (for_player && player_memory_of(nlarn->p, pos).trap)
+    {
+        const trap_t trap = map_trap_at(m, pos);
+        /* especially ones that may cause detours */
+        if (trap == TT_TELEPORT || trap == TT_TRAPDOOR)
+            step_cost += 50;
+        else
+            step_cost += 10;
+    }
+
+    /* penalize fields occupied by monsters: always for monsters,
+       for the player only if (s)he can see the monster */
+    monster *mon = map_get_monster_at(m, pos);
+    if (mon != NULL && (!for_player || monster_in_sight(mon)))
+    {
+        step_cost += 10;
+    }
+
+    /* penalize fields covered with water, fire or cloud */
+    switch (tt)
+    {
+    case LT_WATER:
+        if (map_elem == LE_SWIMMING_MONSTER || map_elem == LE_FLYING_MONSTER)
+            break;
+        /* else fall through */
+    case LT_FIRE:
+    case LT_CLOUD:
+        step_cost += 50;
+        break;
+    default:
+        break;
+    }
+
+    return step_cost;
+}
+
+/* Lower bound of the cost to the nearest goal: each step costs at least 1
+   and may lead diagonally */
+static guint32 path_nearest_estimate(position pos, const position *goals,
+                                     guint count)
+{
+    guint32 best = G_MAXUINT32;
+
+    for (guint i = 0; i < count; i++)
+    {
+        if (!pos_valid(goals[i]) || Z(goals[i]) != Z(pos))
+            continue;
+
+        const guint32 dist = max(abs(X(pos) - X(goals[i])),
+                                 abs(Y(pos) - Y(goals[i])));
+
+        if (dist < best)
+            best = dist;
+    }
+
+    return (best == G_MAXUINT32) ? 0 : best;
+}
+
+/* check if a sphere occupies a position */
+static bool path_sphere_at(position pos)
+{
+    for (guint i = 0; i < nlarn->spheres->len; i++)
+    {
+        sphere *s = g_ptr_array_index(nlarn->spheres, i);
+        if (pos_identical(s->pos, pos))
+            return true;
+    }
+
+    return false;
+}
+
+/* get a node of the current search, resetting it if it is outdated */
+static path_node *path_node_get(guint idx)
+{
+    path_node *node = &pf.nodes[idx];
+
+    if (node->search != pf.search)
+    {
+        node->search  = pf.search;
+        node->g_score = 0;
+        node->h_score = 0;
+        node->parent  = -1;
+        node->state   = PN_UNSEEN;
+        node->goal    = false;
+    }
+
+    return node;
+}
+
+/* Compare two open nodes: lower total cost first, then lower slot */
+static inline bool path_node_before(guint a, guint b)
+{
+    const path_node *na = &pf.nodes[a];
+    const path_node *nb = &pf.nodes[b];
+    const guint32 fa = na->g_score + na->h_score;
+    const guint32 fb = nb->g_score + nb->h_score;
+
+    return (fa < fb) || (fa == fb && na->slot < nb->slot);
+}
+
+static inline void path_heap_set(guint hpos, guint idx)
+{
+    pf.heap[hpos] = idx;
+    pf.nodes[idx].heap_idx = hpos;
+}
+
+static void path_heap_up(guint hpos)
+{
+    const guint idx = pf.heap[hpos];
+
+    while (hpos > 0)
+    {
+        const guint parent = (hpos - 1) / 2;
+
+        if (!path_node_before(idx, pf.heap[parent]))
+            break;
+
+        path_heap_set(hpos, pf.heap[parent]);
+        hpos = parent;
+    }
+
+    path_heap_set(hpos, idx);
+}
+
+static void path_heap_down(guint hpos)
+{
+    const guint idx = pf.heap[hpos];
+
+    while (true)
+    {
+        guint child = 2 * hpos + 1;
+
+        if (child >= pf.heap_len)
+            break;
+
+        if (child + 1 < pf.heap_len
+                && path_node_before(pf.heap[child + 1], pf.heap[child]))
+            child++;
+
+        if (!path_node_before(pf.heap[child], idx))
+            break;
+
+        path_heap_set(hpos, pf.heap[child]);
+        hpos = child;
+    }
+
+    path_heap_set(hpos, idx);
+}
+
+static void path_open_push(guint idx)
+{
+    path_node *node = &pf.nodes[idx];
+
+    node->state = PN_OPEN;
+    node->slot = pf.slots_len;
+    pf.slots[pf.slots_len++] = idx;
+
+    path_heap_set(pf.heap_len++, idx);
+    path_heap_up(node->heap_idx);
+}
+
+static guint path_open_pop()
+{
+    const guint best = pf.heap[0];
+
+    /* remove the best node from the heap */
+    if (--pf.heap_len > 0)
+    {
+        path_heap_set(0, pf.heap[pf.heap_len]);
+        path_heap_down(0);
+    }
+
+    /* fill the freed slot with the last one, which lowers that node's
+       rank among nodes of equal cost */
+    const guint slot = pf.nodes[best].slot;
+
+    if (slot != --pf.slots_len)
+    {
+        const guint moved = pf.slots[pf.slots_len];
+
+        pf.slots[slot] = moved;
+        pf.nodes[moved].slot = slot;
+        path_heap_up(pf.nodes[moved].heap_idx);
+    }
+
+    return best;
+}
+
+static guint path_get_neighbours(map *m, position pos,
+                                 map_element_t element,
+                                 bool for_player,
+                                 const position *goals,
+                                 guint goal_count,
+                                 position neighbours[GD_MAX])
+{
+    guint count = 0;
+
+    for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
+    {
+        if (dir == GD_CURR)
+            continue;
+
+        position new_pos = pos_move(pos, dir);
 
-path *path_find(map *m, position start, position goal, map_element_t element)
-{
-    g_assert(m != NULL);
-    g_assert(pos_valid(start));
-    g_assert(pos_valid(goal));
-    g_assert(element < LE_MAX);
+        if (!pos_valid(new_pos))
+            continue;
 
-    /* if the starting position is on another map, fail for now */
-    /* TODO: could be changed to support 3D path finding */
-    if (Z(start) != Z(goal))
-        return NULL;
+        /* goal tiles are always reachable regardless of who occupies them */
+        bool is_goal = false;
+        for (guint i = 0; i < goal_count; i++)
+        {
+            if (pos_identical(new_pos, goals[i]))
+            {
+                is_goal = true;
+                break;
+            }
+        }
 
-    path *pt = path_new(start, goal);
+        if (is_goal)
+        {
+            neighbours[count++] = new_pos;
+            continue;
+        }
 
-    /* add start to open list */
-    path_element *curr = path_element_new(start);
-    g_ptr_array_add(pt->open, curr);
+        /* block the player's position as an intermediate step */
+        if (pos_identical(new_pos, nlarn->p->pos))
+            continue;
 
-    /* check if the path is being determined for the player */
-    bool for_player = pos_identical(start, nlarn->p->pos);
+        /* block positions occupied by spheres */
+        if (path_sphere_at(new_pos))
+            continue;
 
-    while (pt->open->len)
+        if ((for_player && mt_is_passable(player_memory_of(nlarn->p, new_pos).type))
+                || (!for_player && monster_valid_dest(m, new_pos, element)))
+        {
+            neighbours[count++] = new_pos;
+        }
+    }
+
+    return count;
+}
+
+/* Check if there can be a path from start to goal. Tiles temporarily
+   blocked by the player or spheres are regarded as passable, thus paths
+   ruled out here can not be found by the search either. */
+static bool path_reachable(map *m, position start, position goal,
+                           map_element_t element)
+{
+    /* the goal is entered from one of its neighbours, regardless of
+       what is located on the goal tile */
+    if (pos_adjacent(start, goal))
+        return true;
+
+    const guint16 *label = path_components(m, element);
+    guint16 start_labels[GD_MAX];
+    guint count = 0;
+
+    for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
     {
-        curr = path_find_best(pt);
+        const position npos = pos_move(start, dir);
 
-        g_ptr_array_remove_fast(pt->open, curr);
-        g_ptr_array_add(pt->closed, curr);
+        if (dir != GD_CURR && pos_valid(npos) && label[path_node_idx(npos)])
+            start_labels[count++] = label[path_node_idx(npos)];
+    }
 
-        if (pos_identical(curr->pos, pt->goal))
-        {
-            /* arrived at goal - reconstruct path */
-            do {
-                /* don't need the starting point in the path */
-                if (curr->parent != NULL)
-                    g_queue_push_head(pt->path, curr);
+    for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
+    {
+        const position npos = pos_move(goal, dir);
 
-                curr = curr->parent;
-            } while (curr != NULL);
+        if (dir == GD_CURR || !pos_valid(npos))
+            continue;
 
-            return pt;
+        for (guint i = 0; i < count; i++)
+        {
+            if (label[path_node_idx(npos)] == start_labels[i])
+                return true;
         }
+    }
+
+    return false;
+}
+
+/* Get the connected areas of the map for the kind of movement: tiles in
+   the same area carry the same label, impassable tiles are labelled 0.
+   The labels are determined again after passability has changed. */
+static const guint16 *path_components(map *m, map_element_t element)
+{
+    /* all but the following move like ordinary monsters */
+    if (element != LE_SWIMMING_MONSTER && element != LE_FLYING_MONSTER
+            && element != LE_XORN)
+    {
+        element = LE_MONSTER;
+    }
+
+    guint16 *label = &m->components[element][0][0];
 
-        GPtrArray *neighbours = path_get_neighbours(m, curr->pos, element, for_player, pt->goal);
+    if (m->components_valid & (1 << element))
+        return label;
 
-        while (neighbours->len)
+    memset(label, 0, sizeof(m->components[element]));
+    guint16 next_label = 1;
+
+    for (guint idx = 0; idx < MAP_SIZE; idx++)
+    {
+        if (label[idx] || !monster_valid_dest(m,
+                    path_node_pos(idx, m->nlevel), element))
         {
-            path_element *next = g_ptr_array_remove_index_fast(neighbours,
-                                                neighbours->len - 1);
+            continue;
+        }
 
-            bool next_is_better = false;
+        /* flood the area the tile belongs to */
+        guint head = 0, tail = 0;
+        label[idx] = next_label;
+        cq[tail++] = idx;
+
+        while (head < tail)
+        {
+            const position pos = path_node_pos(cq[head++], m->nlevel);
 
-            if (path_element_in_list(next, pt->closed))
+            for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
             {
-                g_free(next);
-                continue;
-            }
+                const position npos = pos_move(pos, dir);
 
-            const guint32 next_g_score = curr->g_score
-                + path_step_cost(m, next, element, for_player);
+                if (dir == GD_CURR || !pos_valid(npos))
+                    continue;
 
-            if (!path_element_in_list(next, pt->open))
-            {
-                g_ptr_array_add(pt->open, next);
-                next_is_better = true;
-            }
-            else if (next->g_score > next_g_score)
-            {
-                next_is_better = true;
-            }
-            else
-            {
-                g_free(next);
-            }
+                const guint nidx = path_node_idx(npos);
 
-            if (next_is_better)
-            {
-                next->parent  = curr;
-                next->g_score = next_g_score;
+                if (!label[nidx] && monster_valid_dest(m, npos, element))
+                {
+                    label[nidx] = next_label;
+                    cq[tail++] = nidx;
+                }
             }
         }
 
-        g_ptr_array_free(neighbours, true);
+        next_label++;
     }
 
-    /* could not find a path */
-    path_destroy(pt);
+    m->components_valid |= 1 << element;
 
-    return NULL;
+    return label;
 }
 
-void path_destroy(path *path)
+/* get the field for the target, rebuilding it if it is outdated */
+static path_field *path_field_get(map *m, position target,
+                                  map_element_t element)
 {
-    g_assert(path != NULL);
+    path_field *f = pfields[element];
+
+    if (f == NULL)
+        f = pfields[element] = g_malloc0(sizeof(path_field));
 
-    /* clean up open list */
-    for (guint idx = 0; idx < path->open->len; idx++)
+    if (f->m != m || f->gtime != game_turn(nlarn)
+            || !pos_identical(f->target, target))
     {
-        g_free(g_ptr_array_index(path->open, idx));
+        path_field_build(f, m, target, element);
     }
-    g_ptr_array_free(path->open, true);
 
-    for (guint idx = 0; idx < path->closed->len; idx++)
+    return f;
+}
+
+static void path_field_build(path_field *f, map *m, position target,
+                             map_element_t element)
+{
+    f->m      = m;
+    f->gtime  = game_turn(nlarn);
+    f->target = target;
+    f->flee_built = false;
+
+    for (guint idx = 0; idx < MAP_SIZE; idx++)
+        f->dist[idx] = PATH_FIELD_INF;
+
+    f->dist[path_node_idx(target)] = 0;
+    path_field_spread(f->dist, m, target, element, true);
+}
+
+static void path_field_build_flee(path_field *f, map *m,
+                                  map_element_t element)
+{
+    const guint target_idx = path_node_idx(f->target);
+
+    for (guint idx = 0; idx < MAP_SIZE; idx++)
     {
-        g_free(g_ptr_array_index(path->closed, idx));
+        if (idx == target_idx || f->dist[idx] == PATH_FIELD_INF)
+            f->flee[idx] = PATH_FIELD_INF;
+        else
+            f->flee[idx] = -(f->dist[idx] * 6) / 5;
     }
-    g_ptr_array_free(path->closed, true);
 
-    g_queue_free(path->path);
-    g_free(path);
+    /* the target itself is no place to flee to */
+    path_field_spread(f->flee, m, f->target, element, false);
+    f->flee_built = true;
 }
 
-static path *path_new(position start, position goal)
+/*
+ * Dijkstra's algorithm spreading out from all tiles with a value. If
+ * enter_target is set, the target may be entered regardless of its occupant.
+ */
+static void path_field_spread(gint32 *field, map *m, position target,
+                              map_element_t element, bool enter_target)
 {
-    g_assert(pos_valid(start));
-    g_assert(pos_valid(goal));
+    memset(fq.heap_idx, 0xff, sizeof(fq.heap_idx));
+    fq.key = field;
+    fq.len = 0;
 
-    path *pt = g_malloc0(sizeof(path));
+    for (guint idx = 0; idx < MAP_SIZE; idx++)
+    {
+        if (field[idx] != PATH_FIELD_INF)
+            path_field_queue_update(idx);
+    }
 
-    pt->open   = g_ptr_array_new();
-    pt->closed = g_ptr_array_new();
-    pt->path   = g_queue_new();
+    while (fq.len)
+    {
+        const guint curr_idx = path_field_queue_pop();
+        const position cpos = path_node_pos(curr_idx, Z(target));
 
-    pt->start = start;
-    pt->goal  = goal;
+        /* the cost of entering the current tile */
+        gint32 value = field[curr_idx];
+        if (!pos_identical(cpos, target))
+            value += path_step_cost(m, cpos, element, false);
 
-    return pt;
+        position neighbours[GD_MAX];
+        guint count = path_get_neighbours(m, cpos, element, false, &target,
+                                          enter_target ? 1 : 0, neighbours);
+
+        while (count--)
+        {
+            const guint next_idx = path_node_idx(neighbours[count]);
+
+            if (value < field[next_idx])
+            {
+                field[next_idx] = value;
+                path_field_queue_update(next_idx);
+            }
+        }
+    }
 }
 
-static path_element *path_element_new(position pos)
+/* add a tile to the queue or move it up after its distance dropped */
+static void path_field_queue_update(guint idx)
 {
-    g_assert(pos_valid(pos));
+    guint hpos = (fq.heap_idx[idx] < 0) ? fq.len++ : (guint)fq.heap_idx[idx];
+
+    while (hpos > 0)
+    {
+        const guint parent = (hpos - 1) / 2;
+
+        if (fq.key[fq.heap[parent]] <= fq.key[idx])
+            break;
 
-    path_element *lpe = g_malloc0(sizeof(path_element));
-    lpe->pos = pos;
+        fq.heap[hpos] = fq.heap[parent];
+        fq.heap_idx[fq.heap[hpos]] = hpos;
+        hpos = parent;
+    }
 
-    return lpe;
+    fq.heap[hpos] = idx;
+    fq.heap_idx[idx] = hpos;
 }
 
-/* calculate the cost of stepping into this new field */
-static guint path_step_cost(map *m, const path_element* element,
-    map_element_t map_elem, bool for_player)
+static guint path_field_queue_pop()
 {
-    map_tile_t tt;
-    guint32 step_cost = 1; /* at least 1 movement cost */
+    const guint best = fq.heap[0];
+    const guint last = fq.heap[--fq.len];
+    guint hpos = 0;
 
-    /* get the tile type of the map tile */
-    if (for_player)
+    fq.heap_idx[best] = -1;
+
+    if (fq.len == 0)
+        return best;
+
+    while (true)
     {
-        tt = player_memory_of(nlarn->p, element->pos).type ;
+        guint child = 2 * hpos + 1;
+
+        if (child >= fq.len)
+            break;
+
+        if (child + 1 < fq.len
+                && fq.key[fq.heap[child + 1]] < fq.key[fq.heap[child]])
+            child++;
+
+        if (fq.key[fq.heap[child]] >= fq.key[last])
+            break;
+
+        fq.heap[hpos] = fq.heap[child];
+        fq.heap_idx[fq.heap[hpos]] = hpos;
+        hpos = child;
     }
-    else
+
+    fq.heap[hpos] = last;
+    fq.heap_idx[last] = hpos;
+
+    return best;
+}
+
+/* start a new incremental search */
+static void path_dstar_init(map *m, position start, position goal)
+{
+    pd.m     = m;
+    pd.goal  = goal;
+    pd.start = pd.last = start;
+    pd.km    = 0;
+    pd.heap_len = 0;
+
+    /* the costs of tiles are determined when needed first */
+    for (guint idx = 0; idx < MAP_SIZE; idx++)
     {
-        tt = map_tiletype_at(m, element->pos);
+        const position pos = path_node_pos(idx, Z(goal));
+
+        pd.nodes[idx].g = pd.nodes[idx].rhs = PATH_DSTAR_INF;
+        pd.nodes[idx].cost = PATH_DSTAR_UNKNOWN;
+        pd.nodes[idx].heap_idx = -1;
+
+        pd.tiles[idx] = player_memory_of(nlarn->p, pos).type;
+        pd.traps[idx] = player_memory_of(nlarn->p, pos).trap;
     }
 
-    /* penalize for traps known to the player */
-    if (for_player && player_memory_of(nlarn->p, element->pos).trap)
+    pd.occupied_len = 0;
+    path_dstar_update_costs();
+
+    const guint goal_idx = path_node_idx(goal);
+    pd.nodes[goal_idx].rhs = 0;
+    path_dstar_queue_insert(goal_idx);
+}
+
+/* find the tiles the costs of which may have changed since the last search */
+static void path_dstar_update_costs()
+{
+    /* the player's memory of the map */
+    guint idx = 0;
+
+    for (int y = 0; y < MAP_MAX_Y; y++)
     {
-        const trap_t trap = map_trap_at(m, element->pos);
-        /* especially ones that may cause detours */
-        if (trap == TT_TELEPORT || trap == TT_TRAPDOOR)
-            step_cost += 50;
-        else
-            step_cost += 10;
+        for (int x = 0; x < MAP_MAX_X; x++, idx++)
+        {
+            const player_tile_memory *mem = &nlarn->p->memory[Z(pd.goal)][y][x];
+
+            if (mem->type != pd.tiles[idx] || mem->trap != pd.traps[idx])
+            {
+                pd.tiles[idx] = mem->type;
+                pd.traps[idx] = mem->trap;
+                path_dstar_cost_changed(idx);
+            }
+        }
     }
 
-    /* penalize fields occupied by monsters: always for monsters,
-       for the player only if (s)he can see the monster */
-    monster *mon = map_get_monster_at(m, element->pos);
-    if (mon != NULL && (!for_player || monster_in_sight(mon)))
+    /* the tiles occupied before and now */
+    for (guint i = 0; i < pd.occupied_len; i++)
+        path_dstar_cost_changed(pd.occupied[i]);
+
+    pd.occupied_len = 0;
+
+    monster *mon;
+    for (guint i = 0; (mon = fov_visible_monster(nlarn->p->fv, i)); i++)
     {
-        step_cost += 10;
+        const position mpos = monster_pos(mon);
+
+        if (Z(mpos) == Z(pd.goal))
+            pd.occupied[pd.occupied_len++] = path_node_idx(mpos);
     }
 
-    /* penalize fields covered with water, fire or cloud */
-    switch (tt)
+    for (guint i = 0; i < nlarn->spheres->len; i++)
     {
-    case LT_WATER:
-        if (map_elem == LE_SWIMMING_MONSTER || map_elem == LE_FLYING_MONSTER)
-            break;
-        /* else fall through */
-    case LT_FIRE:
-    case LT_CLOUD:
-        step_cost += 50;
-        break;
-    default:
-        break;
+        sphere *sph = g_ptr_array_index(nlarn->spheres, i);
+
+        if (Z(sph->pos) == Z(pd.goal) && pd.occupied_len < MAP_SIZE)
+            pd.occupied[pd.occupied_len++] = path_node_idx(sph->pos);
     }
 
-    return step_cost;
+    for (guint i = 0; i < pd.occupied_len; i++)
+        path_dstar_cost_changed(pd.occupied[i]);
 }
 
-/* Returns the total estimated cost of the best path going
-   through this new field */
-static guint path_cost(path_element* element, position target)
+/* recalculate the cost of a tile and repair the search if it changed */
+static void path_dstar_cost_changed(guint idx)
 {
-    /* estimate the distance from the current position to the target */
-    element->h_score = pos_distance(element->pos, target);
+    /* the search has not used the tile yet */
+    if (pd.nodes[idx].cost == PATH_DSTAR_UNKNOWN)
+        return;
+
+    const guint32 old_cost = pd.nodes[idx].cost;
+    pd.nodes[idx].cost = PATH_DSTAR_UNKNOWN;
 
-    return element->g_score + element->h_score;
+    if (path_dstar_cost(idx) == old_cost)
+        return;
+
+    /* the tile's cost is part of the values of its neighbours */
+    guint neighbours[GD_MAX];
+    guint count = path_dstar_neighbours(idx, neighbours);
+
+    for (guint i = 0; i < count; i++)
+        path_dstar_update_vertex(neighbours[i]);
 }
 
-static path_element *path_element_in_list(const path_element* el, const GPtrArray *list)
+/* the cost of entering a tile, PATH_DSTAR_INF if it is impassable */
+static guint32 path_dstar_cost(guint idx)
 {
-    g_assert(el != NULL && list != NULL);
+    path_dstar_node *node = &pd.nodes[idx];
 
-    for (guint idx = 0; idx < list->len; idx++)
-    {
-        path_element *li = g_ptr_array_index(list, idx);
+    if (node->cost != PATH_DSTAR_UNKNOWN)
+        return node->cost;
+
+    const position pos = path_node_pos(idx, Z(pd.goal));
 
-        if (pos_identical(li->pos, el->pos))
-            return li;
+    /* the goal tile is always reachable regardless of who occupies it */
+    if (!pos_identical(pos, pd.goal)
+            && (!mt_is_passable(player_memory_of(nlarn->p, pos).type)
+                || path_sphere_at(pos)))
+    {
+        node->cost = PATH_DSTAR_INF;
+    }
+    else
+    {
+        node->cost = path_step_cost(pd.m, pos, LE_GROUND, true);
     }
 
-    return NULL;
+    return node->cost;
 }
 
-static path_element *path_find_best(const path *pt)
+static inline void path_dstar_key(guint idx, guint32 key[2])
 {
-    path_element *best = NULL;
+    const path_dstar_node *node = &pd.nodes[idx];
+    const guint32 k = (node->g < node->rhs) ? node->g : node->rhs;
 
-    for (guint idx = 0; idx < pt->open->len; idx++)
+    key[1] = k;
+    key[0] = (k == PATH_DSTAR_INF) ? k : k + pd.km
+        + path_nearest_estimate(path_node_pos(idx, Z(pd.goal)), &pd.start, 1);
+}
+
+static inline bool path_dstar_key_less(const guint32 a[2], const guint32 b[2])
+{
+    return (a[0] < b[0]) || (a[0] == b[0] && a[1] < b[1]);
+}
+
+/* recalculate the lookahead value of a node and queue it if inconsistent */
+static void path_dstar_update_vertex(guint idx)
+{
+    path_dstar_node *node = &pd.nodes[idx];
+
+    if (idx != path_node_idx(pd.goal))
     {
-        path_element *el = g_ptr_array_index(pt->open, idx);
+        guint neighbours[GD_MAX];
+        guint count = path_dstar_neighbours(idx, neighbours);
+
+        node->rhs = PATH_DSTAR_INF;
 
-        if (best == NULL || path_cost(el, pt->goal)
-                < path_cost(best, pt->goal))
+        for (guint i = 0; i < count; i++)
         {
-            best = el;
+            const guint32 cost = path_dstar_cost(neighbours[i]);
+            const guint32 g = pd.nodes[neighbours[i]].g;
+
+            if (cost != PATH_DSTAR_INF && g != PATH_DSTAR_INF
+                    && cost + g < node->rhs)
+            {
+                node->rhs = cost + g;
+            }
         }
     }
 
-    return best;
+    if (node->heap_idx >= 0)
+        path_dstar_queue_remove(idx);
+
+    if (node->g != node->rhs)
+        path_dstar_queue_insert(idx);
 }
 
-static GPtrArray *path_get_neighbours(map *m, position pos,
-                                      map_element_t element,
-                                      bool for_player,
-                                      position goal)
+static void path_dstar_compute()
 {
-    GPtrArray *neighbours = g_ptr_array_new();
+    const guint start_idx = path_node_idx(pd.start);
+    path_dstar_node *start = &pd.nodes[start_idx];
 
-    for (direction dir = GD_NONE + 1; dir < GD_MAX; dir++)
+    while (pd.heap_len)
     {
-        if (dir == GD_CURR)
-            continue;
+        const guint idx = pd.heap[0];
+        path_dstar_node *node = &pd.nodes[idx];
+        guint32 start_key[2];
 
-        position new_pos = pos_move(pos, dir);
+        path_dstar_key(start_idx, start_key);
 
-        if (!pos_valid(new_pos))
-            continue;
+        if (!path_dstar_key_less(node->key, start_key) && start->rhs == start->g)
+            break;
 
-        /* the goal tile is always reachable regardless of who occupies it */
-        if (pos_identical(new_pos, goal))
+        path_expanded++;
+
+        guint32 key[2];
+        path_dstar_key(idx, key);
+
+        if (path_dstar_key_less(node->key, key))
         {
-            g_ptr_array_add(neighbours, path_element_new(new_pos));
+            /* the key is outdated since the start has moved */
+            path_dstar_queue_remove(idx);
+            path_dstar_queue_insert(idx);
             continue;
         }
 
-        /* block the player's position as an intermediate step */
-        if (pos_identical(new_pos, nlarn->p->pos))
-            continue;
+        guint neighbours[GD_MAX];
+        guint count = path_dstar_neighbours(idx, neighbours);
 
-        /* block positions occupied by spheres */
-        bool blocked_by_sphere = false;
-        for (guint i = 0; i < nlarn->spheres->len; i++)
+        if (node->g > node->rhs)
         {
-            sphere *s = g_ptr_array_index(nlarn->spheres, i);
-            if (pos_identical(s->pos, new_pos))
-            {
-                blocked_by_sphere = true;
-                break;
-            }
+            node->g = node->rhs;
+            path_dstar_queue_remove(idx);
+        }
+        else
+        {
+            node->g = PATH_DSTAR_INF;
+            path_dstar_update_vertex(idx);
         }
-        if (blocked_by_sphere)
-            continue;
 
-        if ((for_player && mt_is_passable(player_memory_of(nlarn->p, new_pos).type))
-                || (!for_player && monster_valid_dest(m, new_pos, element)))
+        for (guint i = 0; i < count; i++)
+            path_dstar_update_vertex(neighbours[i]);
+    }
+}
+
+/* get the indices of the tiles surrounding a tile */
+static guint path_dstar_neighbours(guint idx, guint neighbours[GD_MAX])
+{
+    const int x = idx % MAP_MAX_X;
+    const int y = idx / MAP_MAX_X;
+    guint count = 0;
+
+    for (int ny = max(y - 1, 0); ny <= min(y + 1, MAP_MAX_Y - 1); ny++)
+    {
+        for (int nx = max(x - 1, 0); nx <= min(x + 1, MAP_MAX_X - 1); nx++)
         {
-            g_ptr_array_add(neighbours, path_element_new(new_pos));
+            if (nx != x || ny != y)
+                neighbours[count++] = ny * MAP_MAX_X + nx;
         }
     }
 
-    return neighbours;
+    return count;
+}
+
+static void path_dstar_queue_set(guint hpos, guint idx)
+{
+    pd.heap[hpos] = idx;
+    pd.nodes[idx].heap_idx = hpos;
+}
+
+static void path_dstar_queue_sift(guint hpos)
+{
+    const guint idx = pd.heap[hpos];
+    const guint32 *key = pd.nodes[idx].key;
+
+    /* up */
+    while (hpos > 0)
+    {
+        const guint parent = (hpos - 1) / 2;
+
+        if (!path_dstar_key_less(key, pd.nodes[pd.heap[parent]].key))
+            break;
+
+        path_dstar_queue_set(hpos, pd.heap[parent]);
+        hpos = parent;
+    }
+
+    /* down */
+    while (true)
+    {
+        guint child = 2 * hpos + 1;
+
+        if (child >= pd.heap_len)
+            break;
+
+        if (child + 1 < pd.heap_len
+                && path_dstar_key_less(pd.nodes[pd.heap[child + 1]].key,
+                                       pd.nodes[pd.heap[child]].key))
+            child++;
+
+        if (!path_dstar_key_less(pd.nodes[pd.heap[child]].key, key))
+            break;
+
+        path_dstar_queue_set(hpos, pd.heap[child]);
+        hpos = child;
+    }
+
+    path_dstar_queue_set(hpos, idx);
+}
+
+static void path_dstar_queue_insert(guint idx)
+{
+    path_dstar_key(idx, pd.nodes[idx].key);
+    path_dstar_queue_set(pd.heap_len, idx);
+    path_dstar_queue_sift(pd.heap_len++);
+}
+
+static void path_dstar_queue_remove(guint idx)
+{
+    const guint hpos = pd.nodes[idx].heap_idx;
+
+    pd.nodes[idx].heap_idx = -1;
+
+    if (hpos == --pd.heap_len)
+        return;
+
+    path_dstar_queue_set(hpos, pd.heap[pd.heap_len]);
+    path_dstar_queue_sift(hpos);
 }
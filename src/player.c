@@ -118,6 +118,7 @@ static inline void player_item_pickup_ask(player *p, inventory **inv, item *it)
 
 static void player_sobject_memorize(player *p, sobject_t sobject, position pos);
 static int player_sobjects_sort(gconstpointer a, gconstpointer b);
+static void player_memorize_tile(player *p, map *pmap, position pos);
 static cJSON *player_memory_serialize(player *p, position pos);
 static void player_memory_deserialize(player *p, position pos, cJSON *mser);
 static char *player_equipment_list(player *p);
@@ -181,6 +182,7 @@ player *player_new()
 
     /* initialize the field of vision */
     p->fv = fov_new();
+    p->sightlines = fov_new();
 
     return p;
 }
@@ -357,6 +359,7 @@ void player_destroy(player *p)
 
     /* clean the FOV */
     fov_free(p->fv);
+    fov_free(p->sightlines);
 
     g_free(p);
 }
@@ -801,6 +804,7 @@ player *player_deserialize(cJSON *pser)
 
     /* initialize the field of vision */
     p->fv = fov_new();
+    p->sightlines = fov_new();
 
     return p;
 }
@@ -4410,10 +4414,10 @@ void player_search(player *p)
         if (player_effect(p, ET_BLINDNESS))
         {
             /* examine tile types */
-            player_memory_of(p, pos).type = map_tile_at(m, pos)->type;
+            player_memory_of(p, pos).type = map_tiletype_at(m, pos);
 
             /* examine stationary objects */
-            player_memory_of(p, pos).sobject = map_tile_at(m, pos)->sobject;
+            player_memory_of(p, pos).sobject = map_sobject_at(m, pos);
         }
 
         /* search for traps */
@@ -4558,80 +4562,128 @@ void player_update_fov(player *p)
         fov_calculate(p->fv, pmap, p->pos, radius, infravision);
     }
 
+    /* Tiles which have been visible at the last update are memorized
+       already, unless the map or an inventory has been altered since. */
+    const bool renew = (pmap->generation != p->memory_generation)
+                       || (inv_changes() != p->memory_inv_changes);
+
+    p->memory_generation = pmap->generation;
+    p->memory_inv_changes = inv_changes();
+
     /* update visible fields in player's memory */
     for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
     {
-        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
+        const guint64 *row = fov_row(p->fv, Y(pos));
+
+        for (int word = 0; word < MAP_ROW_WORDS; word++)
         {
-            if (fov_get(p->fv, pos))
+            guint64 bits = row[word];
+
+            if (!renew)
+                bits &= ~p->memory_fov[Y(pos)][word];
+
+            p->memory_fov[Y(pos)][word] = row[word];
+
+            for (X(pos) = word * MAP_WORD_BITS; bits != 0; X(pos)++, bits >>= 1)
             {
-                monster *m = map_get_monster_at(pmap, pos);
-                inventory **inv = map_ilist_at(pmap, pos);
+                if (bits & 1)
+                    player_memorize_tile(p, pmap, pos);
+            }
+        }
+    }
+}
 
-                player_memory_of(p,pos).type = map_tiletype_at(pmap, pos);
-                player_memory_of(p,pos).sobject = map_sobject_at(pmap, pos);
+void player_memory_forget(player *p, int nlevel)
+{
+    g_assert(p != NULL && nlevel >= 0 && nlevel < MAP_MAX);
 
-                /* remember certain stationary objects */
-                switch (map_sobject_at(pmap, pos))
-                {
-                case LS_ALTAR:
-                case LS_BANK2:
-                case LS_FOUNTAIN:
-                case LS_MIRROR:
-                case LS_THRONE:
-                case LS_THRONE2:
-                case LS_STATUE:
-                    player_sobject_memorize(p, map_sobject_at(pmap, pos), pos);
-                    break;
+    memset(p->memory[nlevel], 0, sizeof(p->memory[nlevel]));
 
-                default:
-                    player_sobject_forget(p, pos);
-                    break;
-                }
+    /* the tiles in view are not memorized any more */
+    memset(p->memory_fov, 0, sizeof(p->memory_fov));
+    p->memory_generation = 0;
+}
 
-                if (m && monster_flags(m, MIMIC) && monster_unknown(m))
-                {
-                    /* remember the undiscovered mimic as an item */
-                    item *it = get_mimic_item(m);
-                    if (it != NULL)
-                    {
-                        player_memory_of(p,pos).item = it->type;
-                        player_memory_of(p,pos).item_colour = item_colour(it);
-                    }
-                }
-                else if (inv_length(*inv) > 0)
-                {
-                    item *it;
+bool player_seen_from(player *p, position pos)
+{
+    g_assert(p != NULL && pos_valid(pos));
 
-                    /* memorize the most interesting item on the tile */
-                    if (inv_length_filtered(*inv, item_filter_gems) > 0)
-                    {
-                        /* there's a gem in the stack */
-                        it = inv_get_filtered(*inv, 0, item_filter_gems);
-                    }
-                    else if (inv_length_filtered(*inv, item_filter_gold) > 0)
-                    {
-                        /* there is gold in the stack */
-                        it = inv_get_filtered(*inv, 0, item_filter_gold);
-                    }
-                    else
-                    {
-                        /* memorize the topmost item on the stack */
-                        it = inv_get(*inv, inv_length(*inv) - 1);
-                    }
+    if (Z(pos) != Z(p->pos))
+        return false;
 
-                    player_memory_of(p,pos).item = it->type;
-                    player_memory_of(p,pos).item_colour = item_colour(it);
-                }
-                else
-                {
-                    /* no item at that position */
-                    player_memory_of(p,pos).item = IT_NONE;
-                    player_memory_of(p,pos).item_colour = 0;
-                }
-            }
+    /* only recalculated if the player has moved or the map has changed */
+    fov_calculate_symmetric(p->sightlines, game_map(nlarn, Z(p->pos)),
+                            p->pos, MONSTER_VISRANGE_MAX);
+
+    return fov_get(p->sightlines, pos);
+}
+
+static void player_memorize_tile(player *p, map *pmap, position pos)
+{
+    monster *m = map_get_monster_at(pmap, pos);
+    inventory **inv = map_ilist_at(pmap, pos);
+
+    player_memory_of(p,pos).type = map_tiletype_at(pmap, pos);
+    player_memory_of(p,pos).sobject = map_sobject_at(pmap, pos);
+
+    /* remember certain stationary objects */
+    switch (map_sobject_at(pmap, pos))
+    {
+    case LS_ALTAR:
+    case LS_BANK2:
+    case LS_FOUNTAIN:
+    case LS_MIRROR:
+    case LS_THRONE:
+    case LS_THRONE2:
+    case LS_STATUE:
+        player_sobject_memorize(p, map_sobject_at(pmap, pos), pos);
+        break;
+
+    default:
+        player_sobject_forget(p, pos);
+        break;
+    }
+
+    if (m && monster_flags(m, MIMIC) && monster_unknown(m))
+    {
+        /* remember the undiscovered mimic as an item */
+        item *it = get_mimic_item(m);
+        if (it != NULL)
+        {
+            player_memory_of(p,pos).item = it->type;
+            player_memory_of(p,pos).item_colour = item_colour(it);
         }
     }
+    else if (inv_length(*inv) > 0)
+    {
+        item *it;
+
+        /* memorize the most interesting item on the tile */
+        if (inv_length_filtered(*inv, item_filter_gems) > 0)
+        {
+            /* there's a gem in the stack */
+            it = inv_get_filtered(*inv, 0, item_filter_gems);
+        }
+        else if (inv_length_filtered(*inv, item_filter_gold) > 0)
+        {
+            /* there is gold in the stack */
+            it = inv_get_filtered(*inv, 0, item_filter_gold);
+        }
+        else
+        {
+            /* memorize the topmost item on the stack */
+            it = inv_get(*inv, inv_length(*inv) - 1);
+        }
+
+        player_memory_of(p,pos).item = it->type;
+        player_memory_of(p,pos).item_colour = item_colour(it);
+    }
+    else
+    {
+        /* no item at that position */
+        player_memory_of(p,pos).item = IT_NONE;
+        player_memory_of(p,pos).item_colour = 0;
+    }
 }
 
 static guint player_item_pickup(player *p, inventory **inv, item *it, bool ask)
@@ -4806,28 +4858,28 @@ GList *player_visible_threats(player *p, bool ignore_harmless)
 {
     GList *threats = NULL;
 
-    GList *mlist = fov_get_visible_monsters(p->fv);
-    for (GList *iter = mlist; iter != NULL; iter = iter->next)
+    /* prepend from the end to keep the monsters ordered by distance */
+    for (guint idx = fov_visible_monster_count(p->fv); idx > 0; idx--)
     {
-        monster *m = (monster *)iter->data;
+        monster *m = fov_visible_monster(p->fv, idx - 1);
         if (player_monster_is_threat(p, m, ignore_harmless))
-            threats = g_list_append(threats, m);
+            threats = g_list_prepend(threats, m);
     }
 
-    /* free the list returned by fov_get_visible_monsters() */
-    g_list_free(mlist);
-
     return threats;
 }
 
 bool player_adjacent_monster(player *p, bool ignore_harmless)
 {
-    GList *threats = player_visible_threats(p, ignore_harmless);
-    bool monster_visible = (threats != NULL);
+    monster *m;
 
-    g_list_free(threats);
+    for (guint idx = 0; (m = fov_visible_monster(p->fv, idx)); idx++)
+    {
+        if (player_monster_is_threat(p, m, ignore_harmless))
+            return true;
+    }
 
-    return monster_visible;
+    return false;
 }
 
 static int player_sobjects_sort(gconstpointer a, gconstpointer b)
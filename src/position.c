@@ -28,7 +28,8 @@
 #define POS_MAX_XY (1<<10)
 #define POS_MAX_Z  (1<<6)
 
-static void area_flood_worker(area *flood, area *obstacles, int x, int y);
+static inline guint64 *area_row(const area *a, int y);
+static void area_span_set(area *a, int y, int x1, int x2);
 
 const position pos_invalid = { { POS_MAX_XY, POS_MAX_XY, POS_MAX_Z } };
 
@@ -223,10 +224,8 @@ area *area_new(int start_x, int start_y, int size_x, int size_y)
     a->size_x = size_x;
     a->size_y = size_y;
 
-    a->area = g_malloc0(size_y * sizeof(int *));
-
-    for (int y = 0; y < size_y; y++)
-        a->area[y] = g_malloc0(size_x * sizeof(int));
+    a->row_words = (size_x + AREA_WORD_BITS - 1) / AREA_WORD_BITS;
+    a->points = g_malloc0(size_y * a->row_words * sizeof(guint64));
 
     return a;
 }
@@ -406,11 +405,7 @@ void area_destroy(area *a)
 {
     g_assert(a != NULL);
 
-    for (int y = 0; y < a->size_y; y++)
-        g_free(a->area[y]);
-
-    g_free(a->area);
-
+    g_free(a->points);
     g_free(a);
 }
 
@@ -419,16 +414,8 @@ area *area_add(area *a, area *b)
     g_assert (a != NULL && b != NULL);
     g_assert (a->size_x == b->size_x && a->size_y == b->size_y);
 
-    for (int y = 0; y < a->size_y; y++)
-    {
-        for (int x = 0; x < a->size_x; x++)
-        {
-            if (area_point_get(b, x, y))
-            {
-                area_point_set(a, x, y);
-            }
-        }
-    }
+    for (int word = 0; word < a->size_y * a->row_words; word++)
+        a->points[word] |= b->points[word];
 
     area_destroy(b);
 
@@ -442,8 +429,79 @@ area *area_flood(area *obstacles, int start_x, int start_y)
     area *flood = area_new(obstacles->start_x, obstacles->start_y,
                            obstacles->size_x, obstacles->size_y);
 
-    area_flood_worker(flood, obstacles, start_x, start_y);
+    /* the seeds of the spans still to be filled */
+    GArray *seeds = g_array_new(false, false, sizeof(position));
+    position seed = pos_invalid;
+
+    X(seed) = start_x;
+    Y(seed) = start_y;
+
+    /* leave the flood empty when starting outside the area */
+    if (area_point_valid(flood, start_x, start_y))
+        g_array_append_val(seeds, seed);
+
+    while (seeds->len > 0)
+    {
+        seed = g_array_index(seeds, position, seeds->len - 1);
+        g_array_set_size(seeds, seeds->len - 1);
+
+        const int y = Y(seed);
+        int x1 = X(seed), x2 = X(seed);
+
+        /* the seed may have been filled since it has been added */
+        if (area_point_get(obstacles, x1, y) || area_point_get(flood, x1, y))
+            continue;
+
+        /* extend the span to both sides */
+        while (x1 > 0 && !area_point_get(obstacles, x1 - 1, y)
+                && !area_point_get(flood, x1 - 1, y))
+            x1--;
 
+        while (x2 < flood->size_x - 1 && !area_point_get(obstacles, x2 + 1, y)
+                && !area_point_get(flood, x2 + 1, y))
+            x2++;
+
+        area_span_set(flood, y, x1, x2);
+
+        /* add a seed for each open run next to the span in the rows
+           above and below */
+        for (int ny = y - 1; ny <= y + 1; ny += 2)
+        {
+            if (ny < 0 || ny >= flood->size_y)
+                continue;
+
+            const guint64 *obst = area_row(obstacles, ny);
+            const guint64 *filled = area_row(flood, ny);
+            guint64 carry = 0;
+
+            for (int word = x1 / AREA_WORD_BITS; word <= x2 / AREA_WORD_BITS; word++)
+            {
+                /* the columns of the span inside this word */
+                const int lo = max(x1 - word * AREA_WORD_BITS, 0);
+                const int hi = min(x2 - word * AREA_WORD_BITS, AREA_WORD_BITS - 1);
+
+                guint64 open = ~obst[word] & ~filled[word]
+                               & (~(guint64)0 >> (AREA_WORD_BITS - 1 - hi))
+                               & (~(guint64)0 << lo);
+
+                /* the first point of each run */
+                guint64 starts = open & ~((open << 1) | carry);
+                carry = open >> (AREA_WORD_BITS - 1);
+
+                for (int x = word * AREA_WORD_BITS; starts != 0; x++, starts >>= 1)
+                {
+                    if (starts & 1)
+                    {
+                        X(seed) = x;
+                        Y(seed) = ny;
+                        g_array_append_val(seeds, seed);
+                    }
+                }
+            }
+        }
+    }
+
+    g_array_free(seeds, true);
     area_destroy(obstacles);
 
     return flood;
@@ -453,7 +511,7 @@ void area_point_set(area *a, int x, int y)
 {
     g_assert(a != NULL);
     g_assert(area_point_valid(a, x, y));
-    a->area[y][x] = true;
+    area_row(a, y)[x / AREA_WORD_BITS] |= (guint64)1 << (x % AREA_WORD_BITS);
 }
 
 int area_point_get(area *a, int x, int y)
@@ -463,7 +521,7 @@ int area_point_get(area *a, int x, int y)
     if (!area_point_valid(a, x, y))
         return false;
 
-    return a->area[y][x];
+    return (area_row(a, y)[x / AREA_WORD_BITS] >> (x % AREA_WORD_BITS)) & 1;
 }
 
 int area_pos_get(area *a, position pos)
@@ -476,24 +534,22 @@ int area_pos_get(area *a, position pos)
     return area_point_get(a, x, y);
 }
 
-static void area_flood_worker(area *flood, area *obstacles, int x, int y)
+static inline guint64 *area_row(const area *a, int y)
 {
-    /* stepped out of area */
-    if (!area_point_valid(flood, x, y))
-        return;
-
-    /* can't flood this */
-    if (area_point_get(obstacles, x, y))
-        return;
+    return &a->points[y * a->row_words];
+}
 
-    /* been here before */
-    if (area_point_get(flood, x, y))
-        return;
+/* set the points x1 to x2 of a row */
+static void area_span_set(area *a, int y, int x1, int x2)
+{
+    guint64 *row = area_row(a, y);
 
-    area_point_set(flood, x, y);
+    for (int word = x1 / AREA_WORD_BITS; word <= x2 / AREA_WORD_BITS; word++)
+    {
+        const int lo = max(x1 - word * AREA_WORD_BITS, 0);
+        const int hi = min(x2 - word * AREA_WORD_BITS, AREA_WORD_BITS - 1);
 
-    area_flood_worker(flood, obstacles, x + 1, y);
-    area_flood_worker(flood, obstacles, x - 1, y);
-    area_flood_worker(flood, obstacles, x, y + 1);
-    area_flood_worker(flood, obstacles, x, y - 1);
+        row[word] |= (~(guint64)0 >> (AREA_WORD_BITS - 1 - hi))
+                     & (~(guint64)0 << lo);
+    }
 }
@@ -274,23 +274,9 @@ static int potion_with_effect(struct player *p, item *potion)
 
 static int potion_amnesia(player *p, item *potion __attribute__((unused)))
 {
-    position pos = pos_invalid;
-
     g_assert (p != NULL);
 
-    /* set position's level to player's position */
-    Z(pos) = Z(p->pos);
-
-    for (Y(pos) = 0; Y(pos) < MAP_MAX_Y; Y(pos)++)
-    {
-        for (X(pos) = 0; X(pos) < MAP_MAX_X; X(pos)++)
-        {
-            player_memory_of(p, pos).type = LT_NONE;
-            player_memory_of(p, pos).sobject = LS_NONE;
-            player_memory_of(p, pos).item = IT_NONE;
-            player_memory_of(p, pos).trap = TT_NONE;
-        }
-    }
+    player_memory_forget(p, Z(p->pos));
 
     log_add_entry(nlarn->log, _("You stagger for a moment..."));
 
@@ -491,13 +477,13 @@ static int potion_holy_water(player *p, item *potion __attribute__((unused)))
     return false;
 }
 
-bool potion_pos_hit(const GList *traj,
+bool potion_pos_hit(const position *traj, guint step,
     const damage_originator *damo __attribute__((unused)),
     gpointer data1,
     gpointer data2 __attribute__((unused)))
 {
     item *potion = (item *)data1;
-    position pos; pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
     map *pmap = game_map(nlarn, Z(pos));
     map_tile_t mtt = map_tiletype_at(pmap, pos);
     sobject_t mst = map_sobject_at(pmap, pos);
@@ -378,12 +378,12 @@ static int count_adjacent_water_squares(position pos);
 static int try_drying_ground(position pos);
 
 /* no-op trajectory callback: lets the projectile reach the target undisturbed */
-static bool spell_blast_traj_pos_hit(const GList *traj,
+static bool spell_blast_traj_pos_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
 
 /* simple wrapper for spell_area_pos_hit() */
-static bool spell_traj_pos_hit(const GList *traj,
+static bool spell_traj_pos_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
 
@@ -1096,8 +1096,6 @@ static bool spell_type_blast(spell *s, struct player *p)
 
 static bool spell_alter_reality(spell *s, player *p)
 {
-    position pos = { { 0, 0, Z(p->pos) } };
-
     if (Z(p->pos) == 0)
     {
         log_add_entry(nlarn->log, spell_msg_fail(s));
@@ -1105,8 +1103,7 @@ static bool spell_alter_reality(spell *s, player *p)
     }
 
     /* reset the player's memory of the current map */
-    memset(&player_memory_of(p, pos), 0,
-           MAP_MAX_Y * MAP_MAX_X * sizeof(player_tile_memory));
+    player_memory_forget(p, Z(p->pos));
 
     map_destroy(game_map(nlarn, Z(p->pos)));
 
@@ -1336,20 +1333,21 @@ static bool spell_make_wall(spell *s __attribute__((unused)), player *p)
     map *pmap = game_map(nlarn, Z(p->pos));
     if (map_tiletype_at(pmap, pos) != LT_WALL)
     {
-        map_tile *tile = map_tile_at(pmap, pos);
+        inventory **ilist = map_ilist_at(pmap, pos);
 
         /* destroy all items at that position */
-        if (tile->ilist != NULL)
+        if (*ilist != NULL)
         {
-            inv_destroy(tile->ilist, true);
-            tile->ilist = NULL;
+            inv_destroy(*ilist, true);
+            *ilist = NULL;
         }
 
         sobject_destroy_at(p, pmap, pos);
 
         log_add_entry(nlarn->log, _("You have created a wall."));
 
-        tile->type = tile->base_type = LT_WALL;
+        map_basetype_set(pmap, pos, LT_WALL);
+        map_tiletype_set(pmap, pos, LT_WALL);
 
         monster *m;
         if ((m = map_get_monster_at(pmap, pos)))
@@ -1728,8 +1726,8 @@ static int count_adjacent_water_squares(position pos)
             if (pos_identical(p, pos))
                 continue;
 
-            const map_tile *tile = map_tile_at(game_map(nlarn, Z(pos)), p);
-            if (tile->type == LT_WATER || tile->type == LT_DEEPWATER)
+            const map_tile_t type = map_tiletype_at(game_map(nlarn, Z(pos)), p);
+            if (type == LT_WATER || type == LT_DEEPWATER)
                 count++;
         }
 
@@ -1738,8 +1736,9 @@ static int count_adjacent_water_squares(position pos)
 
 static int try_drying_ground(position pos)
 {
-    map_tile *tile = map_tile_at(game_map(nlarn, Z(pos)), pos);
-    if (tile->type == LT_DEEPWATER)
+    map *dmap = game_map(nlarn, Z(pos));
+    const map_tile_t type = map_tiletype_at(dmap, pos);
+    if (type == LT_DEEPWATER)
     {
         /* success chance depends on number of adjacent water squares */
         const int adj_water = count_adjacent_water_squares(pos);
@@ -1749,11 +1748,11 @@ static int try_drying_ground(position pos)
             return false;
         }
 
-        tile->type = LT_WATER;
+        map_tiletype_set(dmap, pos, LT_WATER);
         log_add_entry(nlarn->log, _("The water is more shallow now."));
         return true;
     }
-    else if (tile->type == LT_WATER)
+    else if (type == LT_WATER)
     {
         /* success chance depends on number of adjacent water squares */
         const int adj_water = count_adjacent_water_squares(pos);
@@ -1763,27 +1762,25 @@ static int try_drying_ground(position pos)
             return false;
         }
 
-        if (tile->base_type == LT_NONE)
-            tile->type = LT_DIRT;
-        else
-            tile->type = tile->base_type;
-
-        if (tile->timer)
-            tile->timer = 0;
+        if (map_timer_at(dmap, pos))
+            map_timer_set(dmap, pos, 0);
 
+        if (map_basetype_at(dmap, pos) == LT_NONE)
+            map_tiletype_set(dmap, pos, LT_DIRT);
+        else
+            map_tiletype_set(dmap, pos, map_basetype_at(dmap, pos));
         log_add_entry(nlarn->log, _("The water evaporates!"));
         return true;
     }
     return false;
 }
 
-static bool spell_blast_traj_pos_hit(const GList *traj,
+static bool spell_blast_traj_pos_hit(const position *traj, guint step,
         const damage_originator *damo __attribute__((unused)),
         gpointer data1,
         gpointer data2 __attribute__((unused)))
 {
-    position pos;
-    pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
 
     map *cmap = game_map(nlarn, Z(pos));
 
@@ -1807,12 +1804,11 @@ static bool spell_blast_traj_pos_hit(const GList *traj,
     return false;
 }
 
-static bool spell_traj_pos_hit(const GList *traj,
+static bool spell_traj_pos_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2)
 {
-    position pos;
-    pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
 
     return spell_area_pos_hit(pos, damo, data1, data2);
 }
@@ -248,6 +248,14 @@ monster *monster_trap_trigger(monster *m)
         return m;
     }
 
+    /* Levels can not be generated while the monsters move, as that would
+       register new monsters in the table being walked. Thus trapdoors only
+       lead to levels which exist already. */
+    if (trap == TT_TRAPDOOR && nlarn->maps[Z(monster_pos(m)) + 1] == NULL)
+    {
+        return m;
+    }
+
     /* return if the monster has not triggered the trap */
     if (!chance(trap_chance(trap)))
     {
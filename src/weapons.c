@@ -81,11 +81,11 @@ const weapon_data weapons[WT_MAX] =
 
 /* static functions */
 damage *weapon_get_ranged_damage(player *p, item *weapon, item *ammo);
-bool weapon_ammo_drop(map *m, item *ammo, const GList *traj);
-bool weapon_throw_pos_hit(const GList *traj, const damage_originator *damo,
-    gpointer data1, gpointer data2);
+bool weapon_ammo_drop(map *m, item *ammo, const position *traj, gint step);
+bool weapon_throw_pos_hit(const position *traj, guint step,
+    const damage_originator *damo, gpointer data1, gpointer data2);
 
-static bool weapon_pos_hit(const GList *traj,
+static bool weapon_pos_hit(const position *traj, guint step,
         const damage_originator *damo,
         gpointer data1, gpointer data2);
 
@@ -188,15 +188,14 @@ int weapon_fire(struct player *p, position target)
        but a target supplied directly (e.g. by clicking a monster that
        is visible but hidden behind an obstacle) may have none. Without
        this check the shot would consume ammo and a turn to no effect. */
-    GList *ray = map_ray(pmap, p->pos, target);
-    if (ray == NULL)
+    position ray[MAP_RAY_MAX];
+    if (map_ray_fill(pmap, p->pos, target, ray) == 0)
     {
         log_add_entry(nlarn->log, _("You have no clear shot."));
 
         g_free(wdesc);
         return false;
     }
-    g_list_free(ray);
 
     /* log the event */
     log_add_entry(nlarn->log, _("You fire %s at %s."), wdesc,
@@ -398,24 +397,24 @@ damage *weapon_get_ranged_damage(player *p, item *weapon, item *ammo)
     return dam;
 }
 
-bool weapon_ammo_drop(map *m, item *ammo, const GList *traj)
+bool weapon_ammo_drop(map *m, item *ammo, const position *traj, gint step)
 {
-    /* Due to the recursive usage of this function traj may be NULL
-       (e.g. when the player is wall-walking and shooting at a xorn). */
-    if (traj == NULL)
+    /* Due to the recursive usage of this function step may point before
+       the source (e.g. when the player is wall-walking and shooting at
+       a xorn). */
+    if (step < 0)
     {
         item_destroy(ammo);
         return true;
     }
 
-    position pos;
-    pos_val(pos) = GPOINTER_TO_UINT(traj->data);
+    position pos = traj[step];
     map_tile_t tt = map_tiletype_at(m, pos);
 
     /* If the ammo comes to stop on a solid tile it has to be dropped on
        the last tile that is not solid, i.e. the floor before a wall tile. */
     if (!map_pos_transparent(m, pos))
-        return weapon_ammo_drop(m, ammo, g_list_previous(traj));
+        return weapon_ammo_drop(m, ammo, traj, step - 1);
 
     /* check if the ammo survives usage */
     if (chance(item_fragility(ammo) + 15)
@@ -428,13 +427,12 @@ bool weapon_ammo_drop(map *m, item *ammo, const GList *traj)
     return true;
 }
 
-static bool weapon_pos_hit(const GList *traj,
+static bool weapon_pos_hit(const position *traj, guint step,
         const damage_originator *damo __attribute__((unused)),
         gpointer data1,
         gpointer data2)
 {
-    position cpos;
-    pos_val(cpos) = GPOINTER_TO_UINT(traj->data);
+    position cpos = traj[step];
 
     map *cmap = game_map(nlarn, Z(cpos));
     item *weapon = (item *)data1;
@@ -462,7 +460,7 @@ static bool weapon_pos_hit(const GList *traj,
 
             monster_damage_take(m, dam);
 
-            ammo_handled = weapon_ammo_drop(cmap, ammo, traj);
+            ammo_handled = weapon_ammo_drop(cmap, ammo, traj, step);
             retval = true;
         }
         else
@@ -482,7 +480,7 @@ static bool weapon_pos_hit(const GList *traj,
     if (!ammo_handled && !map_pos_transparent(cmap, cpos))
     {
         /* The ammo hit some map feature -> stop its movement */
-        weapon_ammo_drop(cmap, ammo, traj);
+        weapon_ammo_drop(cmap, ammo, traj, step);
 
         retval = true;
     }
@@ -491,13 +489,12 @@ static bool weapon_pos_hit(const GList *traj,
     return retval;
 }
 
-bool weapon_throw_pos_hit(const GList *traj,
+bool weapon_throw_pos_hit(const position *traj, guint step,
     const damage_originator *damo __attribute__((unused)),
     gpointer data1,
     gpointer data2 __attribute__((unused)))
 {
-    position cpos;
-    pos_val(cpos) = GPOINTER_TO_UINT(traj->data);
+    position cpos = traj[step];
 
     map *cmap = game_map(nlarn, Z(cpos));
     item *weapon = (item *)data1;
@@ -521,7 +518,7 @@ bool weapon_throw_pos_hit(const GList *traj,
                                      DAMO_PLAYER, nlarn->p);
             monster_damage_take(m, dam);
 
-            weapon_handled = weapon_ammo_drop(cmap, weapon, traj);
+            weapon_handled = weapon_ammo_drop(cmap, weapon, traj, step);
             retval = weapon_handled;
         }
         else
@@ -538,7 +535,7 @@ bool weapon_throw_pos_hit(const GList *traj,
 
     if (!weapon_handled && !map_pos_transparent(cmap, cpos))
     {
-        weapon_ammo_drop(cmap, weapon, traj);
+        weapon_ammo_drop(cmap, weapon, traj, step);
         retval = true;
     }
 